@@ -0,0 +1,20 @@
+# Generate the proportional font tables from assets/*.bdf with
+# scripts/bdf2c.py and add them to a target. Shared by the Zephyr build
+# and the host harness.
+set(TEMPDEMO_ROOT ${CMAKE_CURRENT_LIST_DIR}/..)
+
+set(TEMPDEMO_FONTS
+  ${TEMPDEMO_ROOT}/assets/numerals14.bdf
+)
+
+function(tempdemo_fonts target python)
+  set(fonts_c ${CMAKE_CURRENT_BINARY_DIR}/generated/fonts.c)
+  add_custom_command(
+    OUTPUT ${fonts_c}
+    COMMAND ${python} ${TEMPDEMO_ROOT}/scripts/bdf2c.py -o ${fonts_c} ${TEMPDEMO_FONTS}
+    DEPENDS ${TEMPDEMO_ROOT}/scripts/bdf2c.py ${TEMPDEMO_FONTS}
+    COMMENT "Generating font tables"
+  )
+  target_sources(${target} PRIVATE ${fonts_c})
+  target_include_directories(${target} PRIVATE ${TEMPDEMO_ROOT}/src)
+endfunction()
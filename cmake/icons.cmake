@@ -0,0 +1,20 @@
+# Generate the icon tables from assets/ with scripts/img2c.py and add them
+# to a target. Shared by the Zephyr build and the host harness.
+set(TEMPDEMO_ROOT ${CMAKE_CURRENT_LIST_DIR}/..)
+
+set(TEMPDEMO_ICONS
+  ${TEMPDEMO_ROOT}/assets/raindrop.pbm
+  ${TEMPDEMO_ROOT}/assets/flame.pgm
+)
+
+function(tempdemo_icons target python)
+  set(icons_c ${CMAKE_CURRENT_BINARY_DIR}/generated/icons.c)
+  add_custom_command(
+    OUTPUT ${icons_c}
+    COMMAND ${python} ${TEMPDEMO_ROOT}/scripts/img2c.py -o ${icons_c} ${TEMPDEMO_ICONS}
+    DEPENDS ${TEMPDEMO_ROOT}/scripts/img2c.py ${TEMPDEMO_ICONS}
+    COMMENT "Generating icon tables"
+  )
+  target_sources(${target} PRIVATE ${icons_c})
+  target_include_directories(${target} PRIVATE ${TEMPDEMO_ROOT}/src)
+endfunction()
@@ -0,0 +1,560 @@
+// Host harness for the display pipeline.
+//
+//   render_host dump <dir>      write every frame of the scripted run as PBM
+//   render_host compare <dir>   render again and compare against such a dump
+//   render_host bench [frames]  time the individual rendering stages, the
+//                               log codec, rotated packing and icon
+//                               dithering
+//
+// The stub panel mirrors what the SSD1680 receives: full frames on a full
+// refresh, and only the dirty windows in between.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "framebuffer.h"
+#include "history.h"
+#include "log_block.h"
+#include "my_image.h"
+#include "text.h"
+#include "text_cache.h"
+#include "ui.h"
+
+#define FULL_REFRESH_INTERVAL 10
+#define PBM_PITCH ((PANEL_WIDTH + 7) / 8)
+
+// Temperature and humidity in hundredths, crossing the icon thresholds
+static const int readings[][2] = {
+    { 2150, 4000 }, { 2150, 4100 }, { 2200, 4100 }, { 2300, 4500 },
+    { 2450, 4900 }, { 2500, 5000 }, { 2500, 5200 }, { 2600, 5500 },
+    { 2700, 6000 }, { 2800, 6500 }, { 2900, 7000 }, { 3000, 7500 },
+    { 3100, 8000 }, { 3000, 7000 }, { 2800, 6000 }, { 2600, 5000 },
+    { 2400, 4000 }, { 2200, 3000 }, { 2000, 2500 }, { 1850, 2000 },
+    { 1850, 2000 }, { 1900, 2100 }, { 2500, 4900 }, { 2500, 5000 },
+};
+#define NUM_READINGS (sizeof(readings) / sizeof(readings[0]))
+
+// Simulated time between readings: the graph gains a column every
+// second frame
+#define READING_STEP_S (HISTORY_BUCKET_S / 2)
+
+static uint8_t panel[DISPLAY_BUF_SIZE];
+
+// Stand-in for display_write(): place a window into the panel memory
+static void panel_write(const struct fb_rect *r, const uint8_t *buf) {
+    for (int page = 0; page < r->h / 8; page++) {
+        memcpy(&panel[(r->y / 8 + page) * PANEL_WIDTH + r->x], buf, r->w);
+        buf += r->w;
+    }
+}
+
+static void panel_flush(int frame) {
+    static uint8_t window[DISPLAY_BUF_SIZE];
+    struct fb_rect rects[FB_MAX_DIRTY];
+    struct fb_rect full = { 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT };
+    struct fb_rect to;
+    int n = fb_take_dirty(rects, FB_MAX_DIRTY);
+
+    if (frame % FULL_REFRESH_INTERVAL == 0) {
+        fb_pack_window(fb_data(), &full, DISPLAY_ROTATION, panel, &to);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        fb_pack_window(fb_data(), &rects[i], DISPLAY_ROTATION, window, &to);
+        panel_write(&to, window);
+    }
+}
+
+static void render_frame(int frame) {
+    static int shift = 1;
+    static uint32_t now_s;
+    const int16_t sample[HISTORY_CHANNELS] = { readings[frame][0], readings[frame][1] };
+    q16_t temp = Q16_FROM_INT(readings[frame][0]) / 100;
+    q16_t humidity = Q16_FROM_INT(readings[frame][1]) / 100;
+    const q16_t values[UI_FIELD_COUNT] = {
+        [UI_TEMP_C] = temp,
+        [UI_HUMIDITY] = humidity,
+        [UI_HEAT_INDEX_C] = temp,
+    };
+
+    history_add(now_s, sample);
+    now_s += READING_STEP_S;
+
+    if (frame % FULL_REFRESH_INTERVAL == 0) {
+        shift = !shift;
+        ui_set_offset(shift, shift);
+        ui_repaint();
+    }
+    ui_update(values);
+    panel_flush(frame);
+}
+
+// Convert the panel memory to PBM raster rows (MSB first, 1 = black)
+static void panel_to_pbm(uint8_t *pbm) {
+    memset(pbm, 0, PBM_PITCH * PANEL_HEIGHT);
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        for (int x = 0; x < PANEL_WIDTH; x++) {
+            if (!(panel[x + (y / 8) * PANEL_WIDTH] & (0x80 >> (y % 8)))) {
+                pbm[y * PBM_PITCH + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+}
+
+static void frame_path(char *path, size_t len, const char *dir, int frame) {
+    snprintf(path, len, "%s/frame_%03d.pbm", dir, frame);
+}
+
+static int dump(const char *dir) {
+    static uint8_t pbm[PBM_PITCH * PANEL_HEIGHT];
+    char path[512];
+
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        perror(dir);
+        return 1;
+    }
+    for (int frame = 0; frame < (int)NUM_READINGS; frame++) {
+        render_frame(frame);
+        panel_to_pbm(pbm);
+
+        frame_path(path, sizeof(path), dir, frame);
+        FILE *f = fopen(path, "wb");
+        if (!f) {
+            perror(path);
+            return 1;
+        }
+        fprintf(f, "P4\n%d %d\n", PANEL_WIDTH, PANEL_HEIGHT);
+        fwrite(pbm, 1, sizeof(pbm), f);
+        fclose(f);
+    }
+    printf("wrote %d frames to %s\n", (int)NUM_READINGS, dir);
+    return 0;
+}
+
+static int compare(const char *dir) {
+    static uint8_t pbm[PBM_PITCH * PANEL_HEIGHT];
+    static uint8_t ref[PBM_PITCH * PANEL_HEIGHT];
+    char path[512];
+    int failed = 0;
+
+    for (int frame = 0; frame < (int)NUM_READINGS; frame++) {
+        render_frame(frame);
+        panel_to_pbm(pbm);
+
+        frame_path(path, sizeof(path), dir, frame);
+        FILE *f = fopen(path, "rb");
+        int w = 0;
+        int h = 0;
+        if (!f || fscanf(f, "P4 %d %d", &w, &h) != 2 || fgetc(f) == EOF ||
+            w != PANEL_WIDTH || h != PANEL_HEIGHT ||
+            fread(ref, 1, sizeof(ref), f) != sizeof(ref)) {
+            printf("frame %d: cannot read %s\n", frame, path);
+            failed++;
+            if (f) {
+                fclose(f);
+            }
+            continue;
+        }
+        fclose(f);
+
+        int diff = 0;
+        for (size_t i = 0; i < sizeof(pbm); i++) {
+            diff += __builtin_popcount(pbm[i] ^ ref[i]);
+        }
+        if (diff) {
+            printf("frame %d: %d pixels differ\n", frame, diff);
+            failed++;
+        }
+    }
+    printf("%d of %d frames match\n", (int)NUM_READINGS - failed, (int)NUM_READINGS);
+    return failed ? 1 : 0;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void report(const char *name, double ns, int ops, int pixels) {
+    printf("%-28s %10.1f ns/op", name, ns / ops);
+    if (pixels) {
+        printf(" %10.1f Mpixel/s", (double)pixels * ops / ns * 1e3);
+    }
+    printf("\n");
+}
+
+// A slow triangle wave in the DHT11's 0.1 degree steps
+static void log_wave(uint32_t t, int16_t value[HISTORY_CHANNELS]) {
+    uint32_t phase = t % 3600;
+    value[HISTORY_TEMP] = 2150 + (phase < 1800 ? phase : 3600 - phase) / 60 * 10;
+    value[HISTORY_HUMIDITY] = 4500 + (t / 900 % 4) * 100;
+}
+
+static void log_check_sample(uint16_t boot, uint32_t time_s, const int16_t value[HISTORY_CHANNELS],
+                             void *arg) {
+    int *errors = arg;
+    int16_t expect[HISTORY_CHANNELS];
+
+    log_wave(time_s, expect);
+    if (memcmp(value, expect, sizeof(expect)) != 0) {
+        (*errors)++;
+    }
+}
+
+// A day at 1 Hz in 5 minute blocks, as the flash log writes it. Flash
+// bytes add the FCB entry framing with 4 byte write alignment.
+static void bench_log(void) {
+    static uint8_t buf[1024];
+    struct log_block block;
+    long payload = 0, flash = 0;
+    int blocks = 0, errors = 0, samples = 86400;
+    double decode_ns = 0, start, total;
+
+    total = now_ns();
+    log_block_start(&block, buf, sizeof(buf), 0);
+    for (int t = 0; t < samples; t++) {
+        int16_t value[HISTORY_CHANNELS];
+
+        log_wave(t, value);
+        log_block_add(&block, t, value);
+        if (block.count == 300 || t == samples - 1) {
+            size_t len = log_block_finish(&block);
+
+            start = now_ns();
+            log_block_decode(buf, len, log_check_sample, &errors);
+            decode_ns += now_ns() - start;
+            payload += len;
+            flash += ((len > 127 ? 2 : 1) + 3) / 4 * 4 + (len + 3) / 4 * 4 + 4;
+            blocks++;
+            log_block_start(&block, buf, sizeof(buf), 0);
+        }
+    }
+    total = now_ns() - total;
+    report("log block encode", total - decode_ns, samples, 0);
+    report("log block decode", decode_ns, samples, 0);
+    printf("log: %d blocks, %.2f bytes/sample payload, %.2f in flash, "
+           "write amplification %.2f, %d decode errors\n",
+           blocks, (double)payload / samples, (double)flash / samples,
+           (double)flash / payload, errors);
+}
+
+// Reference for fb_pack_window(): every pixel remapped on its own, the
+// way set_pixel() would have to do it for a rotated panel
+static void pack_naive(const uint8_t *frame, const struct fb_rect *r, int rotation, uint8_t *dst,
+                       struct fb_rect *to) {
+    int pitch = rotation % 180 ? PANEL_HEIGHT : PANEL_WIDTH;
+
+    if (rotation == 0) {
+        *to = *r;
+    } else if (rotation == 90) {
+        *to = (struct fb_rect){ PANEL_WIDTH - r->y - r->h, r->x, r->h, r->w };
+    } else if (rotation == 180) {
+        *to = (struct fb_rect){ PANEL_WIDTH - r->x - r->w, PANEL_HEIGHT - r->y - r->h, r->w, r->h };
+    } else {
+        *to = (struct fb_rect){ r->y, PANEL_HEIGHT - r->x - r->w, r->h, r->w };
+    }
+    memset(dst, 0xFF, to->w * to->h / 8);
+    for (int y = r->y; y < r->y + r->h; y++) {
+        for (int x = r->x; x < r->x + r->w; x++) {
+            if (frame[x + (y / 8) * pitch] & (0x80 >> (y % 8))) {
+                continue;
+            }
+            int px = rotation == 0 ? x : rotation == 90 ? PANEL_WIDTH - 1 - y
+                   : rotation == 180 ? PANEL_WIDTH - 1 - x : y;
+            int py = rotation == 0 ? y : rotation == 90 ? x
+                   : rotation == 180 ? PANEL_HEIGHT - 1 - y : PANEL_HEIGHT - 1 - x;
+            dst[(px - to->x) + (py - to->y) / 8 * to->w] &= ~(0x80 >> (py % 8));
+        }
+    }
+}
+
+// Both ways of packing a frame for each rotation, whole frames and a
+// dirty window the size of a value, checked against each other
+static void bench_rotation(int frames) {
+    static uint8_t frame[DISPLAY_BUF_SIZE];
+    static uint8_t fast[DISPLAY_BUF_SIZE];
+    static uint8_t slow[DISPLAY_BUF_SIZE];
+    int errors = 0;
+
+    srand(1);
+    for (size_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)rand();
+    }
+    for (int rotation = 0; rotation < 360; rotation += 90) {
+        struct fb_rect full = { 0, 0, rotation % 180 ? PANEL_HEIGHT : PANEL_WIDTH,
+                                rotation % 180 ? PANEL_WIDTH : PANEL_HEIGHT };
+        struct fb_rect value = { 104, 40, 48, 32 };
+        const struct fb_rect *windows[] = { &full, &value };
+        const char *names[] = { "frame", "window" };
+        char name[40];
+
+        for (int w = 0; w < 2; w++) {
+            struct fb_rect a, b;
+            int pixels = windows[w]->w * windows[w]->h;
+            double start;
+
+            start = now_ns();
+            for (int i = 0; i < frames; i++) {
+                pack_naive(frame, windows[w], rotation, slow, &b);
+            }
+            snprintf(name, sizeof(name), "pack %s %3d naive", names[w], rotation);
+            report(name, now_ns() - start, frames, pixels);
+
+            start = now_ns();
+            for (int i = 0; i < frames; i++) {
+                fb_pack_window(frame, windows[w], rotation, fast, &a);
+            }
+            snprintf(name, sizeof(name), "pack %s %3d blocks", names[w], rotation);
+            report(name, now_ns() - start, frames, pixels);
+
+            if (memcmp(&a, &b, sizeof(a)) != 0 || memcmp(fast, slow, pixels / 8) != 0) {
+                errors++;
+            }
+        }
+    }
+    printf("rotation: %d mismatches against the per-pixel reference\n", errors);
+}
+
+// Reference for draw_string(): every pixel read from the font's own
+// storage and drawn with set_pixel(), the way glyphs were drawn before
+// they were blitted a column word at a time
+static void draw_string_naive(const Font *font, const char *text, int x, int y) {
+    for (; *text; text++) {
+        uint8_t code = (uint8_t)*text;
+        int index = code < 128 ? font->map[code] : 0;
+
+        if (font->orientation == FONT_BITSTREAM) {
+            const FontGlyph *g = &font->metrics[index];
+            for (int col = 0; col < g->width; col++) {
+                for (int row = 0; row < g->rows; row++) {
+                    uint32_t bit = g->offset + (uint32_t)col * g->rows + row;
+                    if (font->glyphs[bit / 8] & (0x80 >> (bit % 8))) {
+                        set_pixel(x + g->x_off + col, y + g->y_off + row);
+                    }
+                }
+            }
+            x += g->advance;
+            continue;
+        }
+
+        const uint8_t *glyph = font->glyphs + index * font->stride;
+        for (int col = 0; col < font->width; col++) {
+            for (int row = 0; row < font->height; row++) {
+                int ink = font->orientation == FONT_COLUMNS_LSB_TOP
+                              ? glyph[col] >> row & 1
+                              : glyph[row] >> (7 - col) & 1;
+                if (ink) {
+                    set_pixel(x + col, y + row);
+                }
+            }
+        }
+        x += font->advance;
+    }
+}
+
+// Every font drawn both ways at each row offset within a page and cut
+// off by each edge of the screen
+static int check_text(void) {
+    static uint8_t expect[DISPLAY_BUF_SIZE];
+    static const Font *const fonts[] = { &font_5x7, &font_7x9, &font_8x10, &font_numerals14 };
+    const char *text = "Humidity 45.67% -12,C";
+    int errors = 0;
+
+    for (size_t f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++) {
+        int width = text_width(fonts[f], text);
+        const int spots[][2] = {
+            { -13, -3 }, { DISPLAY_WIDTH - width / 2, DISPLAY_HEIGHT - 5 },
+        };
+        for (int i = 0; i < 10; i++) {
+            int x = i < 8 ? 3 + i : spots[i - 8][0];
+            int y = i < 8 ? 40 + i : spots[i - 8][1];
+            fb_clear();
+            draw_string_naive(fonts[f], text, x, y);
+            memcpy(expect, fb_data(), sizeof(expect));
+            fb_clear();
+            draw_string(fonts[f], text, x, y);
+            if (memcmp(expect, fb_data(), sizeof(expect)) != 0) {
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+// Reference for the IMG_GRAY4 kernel: the planes unpacked whole, then
+// every pixel's shade read from them and compared with its own threshold
+static void draw_gray4_naive(int x_offset, int y_offset, const Img *image) {
+    static const uint8_t bayer[8][8] = {
+        {  0, 32,  8, 40,  2, 34, 10, 42 },
+        { 48, 16, 56, 24, 50, 18, 58, 26 },
+        { 12, 44,  4, 36, 14, 46,  6, 38 },
+        { 60, 28, 52, 20, 62, 30, 54, 22 },
+        {  3, 35, 11, 43,  1, 33,  9, 41 },
+        { 51, 19, 59, 27, 49, 17, 57, 25 },
+        { 15, 47,  7, 39, 13, 45,  5, 37 },
+        { 63, 31, 55, 23, 61, 29, 53, 21 },
+    };
+
+    static uint8_t planes[4096];
+    const uint8_t *src = image->img_data;
+    size_t len = 0;
+
+    // Unpack every plane first, a byte at a time
+    while (src < image->img_data + image->data_size) {
+        int8_t n = (int8_t)*src++;
+        if (n >= 0) {
+            for (int i = 0; i <= n; i++) {
+                planes[len++] = *src++;
+            }
+        } else if (n != -128) {
+            for (int i = 0; i < 1 - n; i++) {
+                planes[len++] = *src;
+            }
+            src++;
+        }
+    }
+
+    for (int y = 0; y < image->height; y++) {
+        const uint8_t *band = &planes[(y / 8) * 2 * image->pitch];
+        for (int x = 0; x < image->width; x++) {
+            int hi = band[x] >> (7 - y % 8) & 1;
+            int lo = band[image->pitch + x] >> (7 - y % 8) & 1;
+            int sx = x + x_offset, sy = y + y_offset;
+            if (3 * bayer[sy & 7][sx & 7] < 64 * (hi * 2 + lo)) {
+                set_pixel(sx, sy);
+            }
+        }
+    }
+}
+
+// The dithered flame drawn both ways at every offset modulo 8, and cut
+// off by each edge of the screen
+static void bench_dither(int frames) {
+    static uint8_t expect[DISPLAY_BUF_SIZE];
+    const int spots[][2] = { { -20, -20 }, { DISPLAY_WIDTH - 30, DISPLAY_HEIGHT - 25 } };
+    int errors = 0;
+    double start;
+
+    for (int i = 0; i < 66; i++) {
+        int x = i < 64 ? 100 + i % 8 : spots[i - 64][0];
+        int y = i < 64 ? 40 + i / 8 : spots[i - 64][1];
+        fb_clear();
+        draw_gray4_naive(x, y, &flame);
+        memcpy(expect, fb_data(), sizeof(expect));
+        fb_clear();
+        draw_my_image(x, y, &flame);
+        if (memcmp(expect, fb_data(), sizeof(expect)) != 0) {
+            errors++;
+        }
+    }
+
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        draw_gray4_naive(192 + (i & 7), 56 + (i >> 3 & 7), &flame);
+    }
+    report("dither flame per pixel", now_ns() - start, frames, flame.width * flame.height);
+
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        draw_my_image(192 + (i & 7), 56 + (i >> 3 & 7), &flame);
+    }
+    report("dither flame 8 at a time", now_ns() - start, frames, flame.width * flame.height);
+    printf("dither: %d mismatches against the per-pixel reference\n", errors);
+}
+
+static int bench(int frames) {
+    static uint8_t window[DISPLAY_BUF_SIZE];
+    const char *label = "Temperature 23.45,C";
+    struct fb_rect full = { 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT };
+    double start;
+
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        draw_string_naive(&font_8x10, label, 9 + (i & 1), 56);
+    }
+    report("draw_string 8x10 per pixel", now_ns() - start, frames,
+           text_width(&font_8x10, label) * font_8x10.height);
+
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        draw_string(&font_8x10, label, 9 + (i & 1), 56);
+    }
+    report("draw_string 8x10", now_ns() - start, frames,
+           text_width(&font_8x10, label) * font_8x10.height);
+    printf("text: %d mismatches against the per-pixel reference\n", check_text());
+
+    // The layout's labels, drawn directly and through the cache
+    static const char *const labels[] = { "Temperature", "Humidity", "Heat Index" };
+    int label_pixels = 0;
+    for (int l = 0; l < 3; l++) {
+        label_pixels += text_width(&font_8x10, labels[l]) * font_8x10.height;
+    }
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        for (int l = 0; l < 3; l++) {
+            draw_string(&font_8x10, labels[l], 9 + (i & 1), 20 + 35 * l);
+        }
+    }
+    report("labels draw_string", now_ns() - start, frames, label_pixels);
+
+    struct text_cache_stats cache;
+    text_cache_clear();
+    text_cache_get_stats(&cache);
+    uint32_t hits = cache.hits, misses = cache.misses, saved = cache.glyphs_saved;
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        for (int l = 0; l < 3; l++) {
+            text_cache_draw(&font_8x10, labels[l], 9 + (i & 1), 20 + 35 * l);
+        }
+    }
+    report("labels text_cache_draw", now_ns() - start, frames, label_pixels);
+    text_cache_get_stats(&cache);
+    printf("text cache: %u hits, %u misses, %u glyphs saved, %u bytes used\n",
+           cache.hits - hits, cache.misses - misses, cache.glyphs_saved - saved, cache.bytes_used);
+
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        draw_my_image(192 + (i & 1), 56, &flame);
+    }
+    report("draw_my_image flame", now_ns() - start, frames, flame.width * flame.height);
+
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        fb_clear();
+        fb_copy_window(fb_data(), &full, window);
+    }
+    report("frame prep (clear + copy)", now_ns() - start, frames, DISPLAY_WIDTH * DISPLAY_HEIGHT);
+
+    start = now_ns();
+    for (int i = 0; i < frames; i++) {
+        render_frame(i % NUM_READINGS);
+    }
+    report("scripted screen update", now_ns() - start, frames, 0);
+
+    bench_rotation(frames / 10 > 0 ? frames / 10 : 1);
+    bench_dither(frames);
+
+    bench_log();
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static struct framebuffer frame;
+
+    // Built as __ZEPHYR__ (render_host_dt), the frame is the caller's
+    fb_bind(&frame);
+    if (argc >= 3 && strcmp(argv[1], "dump") == 0) {
+        return dump(argv[2]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "compare") == 0) {
+        return compare(argv[2]);
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        return bench(argc >= 3 ? atoi(argv[2]) : 10000);
+    }
+    fprintf(stderr, "usage: %s dump <dir> | compare <dir> | bench [frames]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,12 @@
+// Just enough of <zephyr/drivers/sensor.h> for the host tests
+#ifndef HOST_SHIM_ZEPHYR_DRIVERS_SENSOR_H
+#define HOST_SHIM_ZEPHYR_DRIVERS_SENSOR_H
+
+#include <stdint.h>
+
+struct sensor_value {
+    int32_t val1;  // integer part
+    int32_t val2;  // millionths, same sign as val1
+};
+
+#endif
@@ -0,0 +1,115 @@
+// comfort.c against a double precision reference over the DHT11's range
+// (0-50 C, 20-90 %RH), plus the dry and humid corners where the heat
+// index gets its adjustments.
+#include <math.h>
+#include <stdio.h>
+#include "comfort.h"
+
+// Largest errors accepted, in degrees
+#define TOL_TEMP_F      0.001
+#define TOL_HEAT_INDEX  0.05
+#define TOL_DEW_POINT   0.05
+
+enum { SIMPLE, ROTHFUSZ, DRY, HUMID, BRANCHES };
+
+static const char *const branch_names[] = { "simple", "Rothfusz", "dry", "humid" };
+
+// NWS heat index in F, and which of its formulas applied
+static double ref_heat_index_f(double t, double rh, int *branch) {
+    double simple = 0.5 * (t + 61.0 + (t - 68.0) * 1.2 + rh * 0.094);
+    if ((simple + t) / 2 < 80.0) {
+        *branch = SIMPLE;
+        return simple;
+    }
+
+    double hi = -42.379 + 2.04901523 * t + 10.14333127 * rh - 0.22475541 * t * rh -
+                0.00683783 * t * t - 0.05481717 * rh * rh + 0.00122874 * t * t * rh +
+                0.00085282 * t * rh * rh - 0.00000199 * t * t * rh * rh;
+    *branch = ROTHFUSZ;
+    if (rh < 13.0 && t >= 80.0 && t <= 112.0) {
+        hi -= (13.0 - rh) / 4 * sqrt((17.0 - fabs(t - 95.0)) / 17.0);
+        *branch = DRY;
+    } else if (rh > 85.0 && t >= 80.0 && t <= 87.0) {
+        hi += (rh - 85.0) / 10 * (87.0 - t) / 5;
+        *branch = HUMID;
+    }
+    return hi;
+}
+
+// Magnus formula, Sonntag constants
+static double ref_dew_point_c(double t, double rh) {
+    double gamma = log((rh < 1.0 ? 1.0 : rh) / 100.0) + 17.62 * t / (243.12 + t);
+    return 243.12 * gamma / (17.62 - gamma);
+}
+
+static double q16_to_double(q16_t v) {
+    return v / 65536.0;
+}
+
+static struct sensor_value tenths(int v) {
+    return (struct sensor_value){ v / 10, v % 10 * 100000 };
+}
+
+static int checked[BRANCHES];
+static double worst_hi;
+static double worst_dp;
+static int failures;
+
+static void check(int t10, int rh10) {
+    struct sensor_value t = tenths(t10);
+    struct sensor_value rh = tenths(rh10);
+    struct comfort c = { 0 };
+    double temp_c = t10 / 10.0;
+    double temp_f = temp_c * 9 / 5 + 32;
+    double humidity = rh10 / 10.0;
+    int branch;
+
+    comfort_update(&c, &t, &rh);
+    double hi_f = ref_heat_index_f(temp_f, humidity, &branch);
+    double hi_err = fabs(q16_to_double(c.heat_index_f) - hi_f);
+    double hi_c_err = fabs(q16_to_double(c.heat_index_c) - (hi_f - 32) * 5 / 9);
+    double dp_err = fabs(q16_to_double(c.dew_point_c) - ref_dew_point_c(temp_c, humidity));
+    double f_err = fabs(q16_to_double(c.temp_f) - temp_f);
+
+    checked[branch]++;
+    worst_hi = fmax(worst_hi, fmax(hi_err, hi_c_err));
+    worst_dp = fmax(worst_dp, dp_err);
+    if (f_err > TOL_TEMP_F || hi_err > TOL_HEAT_INDEX || hi_c_err > TOL_HEAT_INDEX ||
+        dp_err > TOL_DEW_POINT) {
+        if (failures++ < 10) {
+            printf("%.1f C %.1f %%: temp_f off by %.4f, heat index %.4f F / %.4f C, "
+                   "dew point %.4f C\n", temp_c, humidity, f_err, hi_err, hi_c_err, dp_err);
+        }
+    }
+}
+
+int main(void) {
+    // DHT11 range in 0.1 steps
+    for (int t10 = 0; t10 <= 500; t10++) {
+        for (int rh10 = 200; rh10 <= 900; rh10 += 5) {
+            check(t10, rh10);
+        }
+    }
+    // Dry air adjustment (RH < 13 %, 80-112 F) and humid air (RH > 85 %,
+    // 80-87 F), partly outside what a DHT11 reports
+    for (int t10 = 265; t10 <= 445; t10++) {
+        for (int rh10 = 10; rh10 < 130; rh10 += 5) {
+            check(t10, rh10);
+        }
+    }
+    for (int t10 = 265; t10 <= 310; t10++) {
+        for (int rh10 = 855; rh10 <= 1000; rh10 += 5) {
+            check(t10, rh10);
+        }
+    }
+
+    for (int b = 0; b < BRANCHES; b++) {
+        printf("%-9s %6d points\n", branch_names[b], checked[b]);
+        if (checked[b] == 0) {
+            failures++;
+        }
+    }
+    printf("worst heat index error %.4f, dew point %.4f, %d failures\n", worst_hi, worst_dp,
+           failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+// dht_decode() fed falling edge times the way dht_capture.c records them:
+// the response edge, then one edge per bit 77 us (0) or 120 us (1) after
+// the one before, with the jitter interrupt latency adds.
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include "dht_decode.h"
+
+static int failures;
+
+#define CHECK(cond)                                                   \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            failures++;                                               \
+        }                                                             \
+    } while (0)
+
+// Edge times for frame starting at start_us, into falls[DHT_FRAME_EDGES]
+static void record(const uint8_t frame[DHT_FRAME_BYTES], uint32_t start_us, uint32_t *falls) {
+    static const int8_t jitter[] = { 0, 3, -2, 6, 1, -4, 9, 2, -1, 4, 12, -3 };
+
+    falls[0] = start_us;
+    // The response's 80 us low and 80 us high come before the first bit
+    falls[1] = start_us + 160;
+    for (int bit = 0; bit < DHT_FRAME_BITS; bit++) {
+        int one = frame[bit / 8] & (0x80 >> (bit % 8));
+        falls[bit + 2] = falls[bit + 1] + (one ? 120 : 77) + jitter[bit % sizeof(jitter)];
+    }
+}
+
+static void frame_with_sum(uint8_t frame[DHT_FRAME_BYTES], uint8_t b0, uint8_t b1, uint8_t b2,
+                           uint8_t b3) {
+    frame[0] = b0;
+    frame[1] = b1;
+    frame[2] = b2;
+    frame[3] = b3;
+    frame[4] = b0 + b1 + b2 + b3;
+}
+
+static void test_good_frames(void) {
+    uint8_t sent[DHT_FRAME_BYTES], got[DHT_FRAME_BYTES];
+    uint32_t falls[DHT_FRAME_EDGES];
+    int humidity, temp;
+
+    // DHT11: 45.0 %, 23.4 C
+    frame_with_sum(sent, 45, 0, 23, 4);
+    record(sent, 1000, falls);
+    CHECK(dht_decode(falls, DHT_FRAME_EDGES, got) == 0);
+    CHECK(memcmp(got, sent, sizeof(got)) == 0);
+    dht11_values(got, &humidity, &temp);
+    CHECK(humidity == 450 && temp == 234);
+
+    // A missed response edge leaves the bits intact
+    CHECK(dht_decode(falls + 1, DHT_FRAME_EDGES - 1, got) == 0);
+    CHECK(memcmp(got, sent, sizeof(got)) == 0);
+
+    // The cycle counter wrapping in the middle of a frame
+    record(sent, 0xFFFFFFFFu - 2000, falls);
+    CHECK(dht_decode(falls, DHT_FRAME_EDGES, got) == 0);
+    CHECK(memcmp(got, sent, sizeof(got)) == 0);
+
+    // All ones and all zeros in the data bytes
+    frame_with_sum(sent, 0xFF, 0x00, 0xFF, 0x00);
+    record(sent, 5000, falls);
+    CHECK(dht_decode(falls, DHT_FRAME_EDGES, got) == 0);
+    CHECK(memcmp(got, sent, sizeof(got)) == 0);
+}
+
+static void test_bad_frames(void) {
+    uint8_t sent[DHT_FRAME_BYTES], got[DHT_FRAME_BYTES];
+    uint32_t falls[DHT_FRAME_EDGES];
+
+    // Checksum off by one
+    frame_with_sum(sent, 45, 0, 23, 4);
+    sent[4]++;
+    record(sent, 1000, falls);
+    CHECK(dht_decode(falls, DHT_FRAME_EDGES, got) == -EBADMSG);
+
+    // One flipped data bit: the sum no longer matches
+    frame_with_sum(sent, 45, 0, 23, 4);
+    sent[2] ^= 0x08;
+    record(sent, 1000, falls);
+    CHECK(dht_decode(falls, DHT_FRAME_EDGES, got) == -EBADMSG);
+
+    // Truncated transfers
+    frame_with_sum(sent, 45, 0, 23, 4);
+    record(sent, 1000, falls);
+    CHECK(dht_decode(falls, DHT_FRAME_BITS, got) == -ENODATA);
+    CHECK(dht_decode(falls, 12, got) == -ENODATA);
+    CHECK(dht_decode(falls, 0, got) == -ENODATA);
+
+    // An edge lost in the middle merges two bits into one long period
+    uint32_t lost[DHT_FRAME_EDGES];
+    memcpy(lost, falls, 20 * sizeof(falls[0]));
+    memcpy(lost + 20, falls + 21, (DHT_FRAME_EDGES - 21) * sizeof(falls[0]));
+    CHECK(dht_decode(lost, DHT_FRAME_EDGES - 1, got) == -EIO);
+}
+
+static void test_pulse_widths(void) {
+    uint8_t sent[DHT_FRAME_BYTES], got[DHT_FRAME_BYTES];
+    uint32_t falls[DHT_FRAME_EDGES];
+    // Bit 10 is a 0, decoded from the period between edges 11 and 12
+    const int edge = 12;
+
+    frame_with_sum(sent, 45, 0, 23, 4);
+    struct {
+        int period;
+        int err;
+        int one;
+    } cases[] = {
+        { 59, -EIO, 0 },    // glitch
+        { 60, 0, 0 },
+        { 99, 0, 0 },
+        { 100, -EBADMSG, 1 },  // read as a 1, the checksum catches it
+        { 160, -EBADMSG, 1 },
+        { 161, -EIO, 0 },   // stretched
+        { 400, -EIO, 0 },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        record(sent, 1000, falls);
+        int shift = (int)(falls[edge - 1] + cases[i].period) - (int)falls[edge];
+        for (int e = edge; e < DHT_FRAME_EDGES; e++) {
+            falls[e] += shift;
+        }
+        int err = dht_decode(falls, DHT_FRAME_EDGES, got);
+        CHECK(err == cases[i].err);
+        if (err != -EIO) {
+            CHECK(!!(got[1] & 0x20) == cases[i].one);
+        }
+        if (err != cases[i].err) {
+            printf("  period %d us gave %d\n", cases[i].period, err);
+        }
+    }
+}
+
+static void test_values(void) {
+    uint8_t frame[DHT_FRAME_BYTES];
+    int humidity, temp;
+
+    // DHT11 with tenths, negative flag in bit 7 of byte 3
+    frame_with_sum(frame, 20, 0, 5, 0x83);
+    dht11_values(frame, &humidity, &temp);
+    CHECK(humidity == 200 && temp == -53);
+
+    frame_with_sum(frame, 90, 0, 0, 0x81);
+    dht11_values(frame, &humidity, &temp);
+    CHECK(humidity == 900 && temp == -1);
+
+    frame_with_sum(frame, 55, 0, 50, 0);
+    dht11_values(frame, &humidity, &temp);
+    CHECK(humidity == 550 && temp == 500);
+
+    // DHT22: 65.2 %, -10.1 C in sign and magnitude
+    frame_with_sum(frame, 0x02, 0x8C, 0x80, 0x65);
+    dht22_values(frame, &humidity, &temp);
+    CHECK(humidity == 652 && temp == -101);
+
+    // -40.0 C, the DHT22's lower limit
+    frame_with_sum(frame, 0x03, 0xE8, 0x81, 0x90);
+    dht22_values(frame, &humidity, &temp);
+    CHECK(humidity == 1000 && temp == -400);
+
+    frame_with_sum(frame, 0x01, 0x90, 0x01, 0x0F);
+    dht22_values(frame, &humidity, &temp);
+    CHECK(humidity == 400 && temp == 271);
+}
+
+int main(void) {
+    test_good_frames();
+    test_bad_frames();
+    test_pulse_widths();
+    test_values();
+    printf("dht_decode: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+// History characteristic payloads: where a transfer starts for a given
+// uptime, packing at different MTUs, resuming from the last uptime a
+// client received, and samples dropping out of a small ring while a
+// transfer is under way.
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include "ess_history.h"
+#include "history.h"
+
+static int failures;
+
+#define CHECK(cond)                                                   \
+    do {                                                              \
+        if (!(cond)) {                                                \
+            printf("%s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            failures++;                                               \
+        }                                                             \
+    } while (0)
+
+// Sample n is taken at 10 * (n + 1) s
+static void add_samples(int from, int to) {
+    for (int n = from; n < to; n++) {
+        const int16_t value[HISTORY_CHANNELS] = {
+            [HISTORY_TEMP] = (int16_t)(-500 + 37 * n),
+            [HISTORY_HUMIDITY] = (int16_t)(4000 + n),
+        };
+        history_add(10 * (n + 1), value);
+    }
+}
+
+// Check the records of one notification against the sample numbers they
+// should hold, returns the count
+static int check_packet(const uint8_t *buf, uint16_t len, int first) {
+    int count = buf[0];
+
+    CHECK(len == 1 + count * ESS_HISTORY_RECORD_SIZE);
+    for (int i = 0; i < count; i++) {
+        const uint8_t *rec = &buf[1 + i * ESS_HISTORY_RECORD_SIZE];
+        int n = first + i;
+        CHECK(sys_get_le32(rec) == 10u * (n + 1));
+        CHECK((int16_t)sys_get_le16(rec + 4) == -500 + 37 * n);
+        CHECK(sys_get_le16(rec + 6) == 4000 + n);
+    }
+    return count;
+}
+
+// A whole transfer from next on; returns the number of notifications
+static int transfer(uint32_t next, uint16_t size, int first, int expect_samples) {
+    uint8_t buf[256];
+    int packets = 0, samples = 0;
+
+    for (;;) {
+        uint16_t len = ess_history_pack(buf, size, &next);
+        int count = check_packet(buf, len, first + samples);
+        packets++;
+        CHECK(len <= size);
+        if (count == 0) {
+            break;
+        }
+        samples += count;
+    }
+    CHECK(samples == expect_samples);
+    return packets;
+}
+
+int main(void) {
+    uint8_t buf[256];
+    uint32_t next = 0;
+
+    // Empty ring: the transfer ends at once
+    CHECK(ess_history_first_after(0) == 0);
+    CHECK(ess_history_pack(buf, 20, &next) == 1 && buf[0] == 0);
+
+    add_samples(0, 10);
+    CHECK(ess_history_first_after(0) == 0);
+    CHECK(ess_history_first_after(9) == 0);
+    CHECK(ess_history_first_after(10) == 1);
+    CHECK(ess_history_first_after(55) == 5);
+    CHECK(ess_history_first_after(99) == 9);
+    CHECK(ess_history_first_after(100) == 10);
+    CHECK(ess_history_first_after(1000) == 10);
+
+    // Default 23 byte MTU (two records per notification) and a large one
+    CHECK(transfer(0, 20, 0, 10) == 6);
+    CHECK(transfer(0, 244, 0, 10) == 2);
+
+    // Resuming after the last uptime received
+    CHECK(transfer(ess_history_first_after(40), 20, 4, 6) == 4);
+
+    // Samples arriving during a transfer are sent too
+    next = 0;
+    CHECK(check_packet(buf, ess_history_pack(buf, 20, &next), 0) == 2);
+    add_samples(10, 12);
+    transfer(next, 20, 2, 10);
+
+    // The ring (HISTORY_DEPTH samples) overtakes a stalled transfer: it
+    // carries on with the oldest sample still held
+    next = 1;
+    add_samples(12, 12 + HISTORY_DEPTH);
+    int oldest = 12 + HISTORY_DEPTH - history_count();
+    CHECK(history_count() == HISTORY_DEPTH);
+    transfer(next, 20, oldest, HISTORY_DEPTH);
+    CHECK(ess_history_first_after(0) == (uint32_t)oldest);
+
+    printf("ess_history: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
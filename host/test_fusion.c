@@ -0,0 +1,68 @@
+// fuse(): medians of odd and even counts, outlier rejection, the even
+// pair too far apart to average, and rounding of negative means.
+#include <stdio.h>
+#include "fusion.h"
+
+static int failures;
+
+static void check(const char *name, const int16_t *in, int n, int16_t max_dev, int16_t expect) {
+    int16_t values[8];
+
+    for (int i = 0; i < n; i++) {
+        values[i] = in[i];
+    }
+    int16_t got = fuse(values, n, max_dev);
+    if (got != expect) {
+        printf("%s: got %d, expected %d\n", name, got, expect);
+        failures++;
+    }
+    for (int i = 1; i < n; i++) {
+        if (values[i - 1] > values[i]) {
+            printf("%s: values not sorted\n", name);
+            failures++;
+            break;
+        }
+    }
+}
+
+#define CHECK_FUSE(name, max_dev, expect, ...)                                        \
+    do {                                                                              \
+        const int16_t in[] = { __VA_ARGS__ };                                         \
+        check(name, in, sizeof(in) / sizeof(in[0]), max_dev, expect);                 \
+    } while (0)
+
+int main(void) {
+    // Hundredths of a degree, as the render thread passes them
+    CHECK_FUSE("single probe", 100, 2345, 2345);
+    CHECK_FUSE("single probe, median only", 0, -120, -120);
+
+    CHECK_FUSE("odd median", 0, 2210, 2250, 2190, 2210);
+    CHECK_FUSE("even median", 0, 2200, 2250, 2150);
+    CHECK_FUSE("even median, negative", 0, -150, -100, -200);
+
+    CHECK_FUSE("odd mean", 100, 2217, 2250, 2190, 2210);
+    CHECK_FUSE("even mean", 100, 2200, 2250, 2150, 2170, 2230);
+
+    // One failing probe is left out of the mean
+    CHECK_FUSE("odd outlier", 100, 2217, 2250, 8500, 2190, 2210);
+    CHECK_FUSE("low outlier", 100, 2217, 2250, 2190, -4000, 2210, 2216);
+    CHECK_FUSE("outlier of two", 100, 2210, 2210, 2210, 9999);
+
+    // The middle pair is further apart than max_dev from its midpoint:
+    // nothing is within range, the median stands
+    CHECK_FUSE("even pair apart", 100, 2500, 2000, 3000);
+    CHECK_FUSE("even pairs apart", 50, 2500, 1000, 2200, 2800, 4000);
+
+    // Mean rounded half away from zero on both sides
+    CHECK_FUSE("round up", 10, 3, 2, 3);
+    CHECK_FUSE("round down negative", 10, -3, -2, -3);
+    CHECK_FUSE("third, negative", 10, -1, -1, -1, -2);
+    CHECK_FUSE("two thirds, negative", 10, -2, -1, -1, -3);
+
+    // Limits of int16_t do not overflow the sum
+    CHECK_FUSE("large values", 10, 32765, 32767, 32763, 32765);
+    CHECK_FUSE("large negative", 10, -32765, -32767, -32763, -32765);
+
+    printf("fusion: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
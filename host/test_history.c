@@ -0,0 +1,120 @@
+// history_stats() against a brute-force scan: a long pseudo-random series
+// with random gaps, so samples leave the ring both by age and by
+// overflow, the ring and the deques wrap many times, and the trend sums
+// are rebased at every drop. The slope is checked against one worked out
+// in double precision.
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "history.h"
+
+#define SAMPLES 200000
+
+static int failures;
+
+// The samples the ring should hold, oldest first
+static struct history_sample expect[HISTORY_DEPTH];
+static int expect_count;
+
+static void expect_add(uint32_t time_s, const int16_t value[HISTORY_CHANNELS]) {
+    int keep = 0;
+
+    // Same rule as history_add(): by age first, then by room
+    while (keep < expect_count && time_s - expect[keep].time_s >= HISTORY_WINDOW_S) {
+        keep++;
+    }
+    if (expect_count - keep == HISTORY_DEPTH) {
+        keep++;
+    }
+    for (int i = keep; i < expect_count; i++) {
+        expect[i - keep] = expect[i];
+    }
+    expect_count -= keep;
+    expect[expect_count].time_s = time_s;
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        expect[expect_count].value[c] = value[c];
+    }
+    expect_count++;
+}
+
+static int check(int n, int channel) {
+    struct history_stats s;
+    int64_t sum = 0;
+    int16_t min = INT16_MAX, max = INT16_MIN;
+    double st = 0, sy = 0, stt = 0, sty = 0;
+
+    if (history_stats(channel, &s) != 0 || s.count != expect_count ||
+        history_count() != expect_count) {
+        printf("sample %d: %d samples held, expected %d\n", n, history_count(), expect_count);
+        return 1;
+    }
+    for (int i = 0; i < expect_count; i++) {
+        const struct history_sample *got = history_get(expect_count - 1 - i);
+        int16_t v = expect[i].value[channel];
+        double t = expect[i].time_s - expect[0].time_s;
+
+        if (!got || got->time_s != expect[i].time_s || got->value[channel] != v) {
+            printf("sample %d: ring differs at age %d\n", n, expect_count - 1 - i);
+            return 1;
+        }
+        sum += v;
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+        st += t;
+        sy += v;
+        stt += t * t;
+        sty += t * v;
+    }
+
+    int64_t half = sum >= 0 ? expect_count / 2 : -(expect_count / 2);
+    int16_t mean = (int16_t)((sum + half) / expect_count);
+    double den = expect_count * stt - st * st;
+    double trend = den != 0 ? (expect_count * sty - st * sy) / den * 3600 : 0;
+    uint32_t span = expect[expect_count - 1].time_s - expect[0].time_s;
+
+    if (s.min != min || s.max != max || s.mean != mean || s.span_s != span ||
+        s.trend_per_hour < trend - 1 || s.trend_per_hour > trend + 1) {
+        printf("sample %d, channel %d: min %d max %d mean %d span %u trend %ld, "
+               "expected %d %d %d %u %.2f\n", n, channel, s.min, s.max, s.mean,
+               (unsigned)s.span_s, (long)s.trend_per_hour, min, max, mean, (unsigned)span,
+               trend);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    struct history_stats s;
+    int16_t value[HISTORY_CHANNELS] = { 2000, 5000 };
+    // Late in a long uptime, so times are large next to the window
+    uint32_t time_s = 3000000000u;
+
+    srand(11);
+    if (history_stats(HISTORY_TEMP, &s) != -ENODATA) {
+        printf("stats of an empty ring\n");
+        failures++;
+    }
+
+    for (int n = 0; n < SAMPLES && failures < 10; n++) {
+        // Mostly short steps that fill the ring before the window ends,
+        // some long ones that age samples out, now and then a gap longer
+        // than the window that empties it
+        int r = rand() % 100;
+        time_s += r < 70 ? 1 + rand() % 5 : r < 99 ? 1 + rand() % (HISTORY_WINDOW_S / 4)
+                                                   : HISTORY_WINDOW_S + rand() % 100;
+
+        // A random walk for temperature, humidity jumping to the extremes
+        value[HISTORY_TEMP] += rand() % 201 - 100;
+        value[HISTORY_HUMIDITY] = rand() % 10 == 0 ? (rand() & 1 ? INT16_MAX : INT16_MIN)
+                                                   : (int16_t)(rand() % 65536 - 32768);
+
+        history_add(time_s, value);
+        expect_add(time_s, value);
+        for (int c = 0; c < HISTORY_CHANNELS; c++) {
+            failures += check(n, c);
+        }
+    }
+
+    printf("history: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
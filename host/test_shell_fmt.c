@@ -0,0 +1,113 @@
+// Helpers behind the shell commands: fixed point values in and out of
+// the tuning commands, and the PBM rows `app frame` prints.
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "centi.h"
+#include "framebuffer.h"
+
+static int failures;
+
+static void check_parse(const char *s, int expect_err, int32_t expect) {
+    int32_t got = 12345678;
+    int err = parse_centi(s, &got);
+
+    if (err != expect_err) {
+        printf("parse_centi(\"%s\"): returned %d, expected %d\n", s, err, expect_err);
+        failures++;
+    } else if (!err && got != expect) {
+        printf("parse_centi(\"%s\"): got %ld, expected %ld\n", s, (long)got, (long)expect);
+        failures++;
+    } else if (err && got != 12345678) {
+        printf("parse_centi(\"%s\"): wrote a value on error\n", s);
+        failures++;
+    }
+}
+
+static void check_str(int32_t centi, const char *expect) {
+    char buf[16];
+
+    if (strcmp(centi_str(buf, sizeof(buf), centi), expect)) {
+        printf("centi_str(%ld): got \"%s\", expected \"%s\"\n", (long)centi, buf, expect);
+        failures++;
+    }
+}
+
+// Each row against the pixels read one at a time from the column layout
+static void check_rows(const uint8_t *frame, const char *name) {
+    uint8_t row[(DISPLAY_WIDTH + 7) / 8 + 1];
+
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        row[sizeof(row) - 1] = 0xA5;
+        fb_pbm_row(frame, y, row);
+        for (int x = 0; x < (int)(sizeof(row) - 1) * 8; x++) {
+            int black = x < DISPLAY_WIDTH &&
+                        !(frame[x + y / 8 * DISPLAY_WIDTH] & 0x80 >> (y % 8));
+            if (!!(row[x / 8] & 0x80 >> (x % 8)) != black) {
+                printf("%s: pixel (%d, %d) wrong\n", name, x, y);
+                failures++;
+                return;
+            }
+        }
+        if (row[sizeof(row) - 1] != 0xA5) {
+            printf("%s: row %d written past its end\n", name, y);
+            failures++;
+            return;
+        }
+    }
+}
+
+int main(void) {
+    static uint8_t frame[DISPLAY_BUF_SIZE];
+
+    check_parse("26", 0, 2600);
+    check_parse("-1.5", 0, -150);
+    check_parse("45.25", 0, 4525);
+    check_parse("0.05", 0, 5);
+    check_parse("-0.05", 0, -5);
+    check_parse("0", 0, 0);
+    check_parse("", -EINVAL, 0);
+    check_parse("-", -EINVAL, 0);
+    check_parse(".", -EINVAL, 0);
+    check_parse("-.", -EINVAL, 0);
+    check_parse(".5", -EINVAL, 0);
+    check_parse("1.", -EINVAL, 0);
+    check_parse("1.234", -EINVAL, 0);
+    check_parse("1..2", -EINVAL, 0);
+    check_parse("--1", -EINVAL, 0);
+    check_parse("1a", -EINVAL, 0);
+    check_parse("99999999", -EINVAL, 0);
+
+    check_str(0, "0.00");
+    check_str(5, "0.05");
+    check_str(-5, "-0.05");
+    check_str(-150, "-1.50");
+    check_str(12345, "123.45");
+    check_str(INT32_MIN, "-21474836.48");
+
+    // Round trip over the range the tuning commands take
+    for (int32_t v = -10000; v <= 10000; v += 7) {
+        char buf[16];
+        int32_t back;
+        if (parse_centi(centi_str(buf, sizeof(buf), v), &back) || back != v) {
+            printf("round trip of %ld failed\n", (long)v);
+            failures++;
+            break;
+        }
+    }
+
+    memset(frame, 0xFF, sizeof(frame));
+    check_rows(frame, "white");
+    memset(frame, 0x00, sizeof(frame));
+    check_rows(frame, "black");
+    srand(1);
+    for (size_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = rand();
+    }
+    check_rows(frame, "noise");
+
+    printf("shell_fmt: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
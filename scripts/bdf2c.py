@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Convert BDF bitmap fonts into the proportional Font tables in text.h.
+
+Each input becomes one `const Font font_<name>` named after the file. Only
+7-bit ASCII glyphs are kept; codes the font lacks map to glyph 0, which is
+always a blank space (the font's own, or an empty one of advance 1/3 em).
+
+  bdf2c.py -o fonts.c assets/numerals14.bdf
+
+TrueType or OpenType sources are rasterised to BDF first, e.g. with
+`otf2bdf -p 14 font.ttf`, and the result kept under assets/. The panel is
+1 bit deep, so glyphs are drawn without anti-aliasing.
+
+Layout (FONT_BITSTREAM):
+  every glyph is cropped to its inked box. Its columns are stored left to
+  right, each column `rows` bits top to bottom, MSB first, and all glyphs
+  are concatenated into one bitstream with no padding in between. The
+  metrics table holds the bit offset, box size, bearing and advance.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+def read_bdf(path):
+    props = {}
+    glyphs = {}
+    with open(path) as f:
+        lines = iter(f.read().splitlines())
+
+    glyph = None
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        key = words[0]
+        if key in ('FONT_ASCENT', 'FONT_DESCENT'):
+            props[key] = int(words[1])
+        elif key == 'STARTCHAR':
+            glyph = {'name': ' '.join(words[1:])}
+        elif key == 'ENCODING':
+            glyph['code'] = int(words[1])
+        elif key == 'DWIDTH':
+            glyph['advance'] = int(words[1])
+        elif key == 'BBX':
+            glyph['bbx'] = [int(w) for w in words[1:5]]
+        elif key == 'BITMAP':
+            w, h = glyph['bbx'][0], glyph['bbx'][1]
+            rows = []
+            for _ in range(h):
+                bits = int(next(lines).strip(), 16)
+                nbits = ((w + 7) // 8) * 8
+                rows.append([(bits >> (nbits - 1 - x)) & 1 for x in range(w)])
+            glyph['rows'] = rows
+        elif key == 'ENDCHAR':
+            if 0 <= glyph.get('code', -1) < 128:
+                glyphs[glyph['code']] = glyph
+            glyph = None
+
+    if 'FONT_ASCENT' not in props or 'FONT_DESCENT' not in props:
+        raise ValueError(f'{path}: FONT_ASCENT and FONT_DESCENT are required')
+    return props['FONT_ASCENT'], props['FONT_DESCENT'], glyphs
+
+
+def crop(glyph, ascent):
+    """Trim blank rows and columns; returns x_off, y_off, width, rows, bits."""
+    w, h, bx, by = glyph['bbx']
+    rows = glyph['rows']
+    inked = [(x, y) for y in range(h) for x in range(w) if rows[y][x]]
+    if not inked:
+        return 0, 0, 0, 0, []
+    x0 = min(x for x, _ in inked)
+    x1 = max(x for x, _ in inked)
+    y0 = min(y for _, y in inked)
+    y1 = max(y for _, y in inked)
+
+    # BDF boxes sit on the baseline, the cell is measured from its top row
+    top = ascent - (by + h) + y0
+    bits = [rows[y][x] for x in range(x0, x1 + 1) for y in range(y0, y1 + 1)]
+    return bx + x0, top, x1 - x0 + 1, y1 - y0 + 1, bits
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ' '.join(f'0x{b:02x},' for b in data[i:i + 16]))
+    return '\n'.join(lines)
+
+
+def glyph_label(code):
+    return repr(chr(code)) if chr(code) != '\\' else "'\\\\'"
+
+
+def emit(name, src, ascent, descent, glyphs):
+    height = ascent + descent
+    if height > 16:
+        sys.exit(f'{src}: fonts taller than 16 pixels are not supported')
+
+    # Glyph 0 is the blank every unmapped code falls back to
+    codes = sorted(glyphs)
+    if 32 in codes:
+        codes.remove(32)
+        order = [32] + codes
+    else:
+        order = [None] + codes
+
+    bits = []
+    metrics = []
+    widest = 0
+    for code in order:
+        if code is None:
+            metrics.append((0, 0, 0, 0, 0, max(1, height // 3), 'blank'))
+            continue
+        x_off, y_off, width, rows, glyph_bits = crop(glyphs[code], ascent)
+        if width > 16:
+            sys.exit(f'{src}: glyph {glyph_label(code)} is wider than 16 pixels')
+        if rows and (y_off < 0 or y_off + rows > height):
+            sys.exit(f'{src}: glyph {glyph_label(code)} leaves the font cell')
+        if x_off < 0 or x_off + width > glyphs[code]['advance']:
+            # The UI clears and redraws single characters by their cells
+            sys.exit(f'{src}: glyph {glyph_label(code)} is drawn outside its advance')
+        metrics.append((len(bits), width, rows, x_off, y_off, glyphs[code]['advance'],
+                        glyph_label(code)))
+        bits += glyph_bits
+        widest = max(widest, width)
+
+    data = bytearray((len(bits) + 7) // 8)
+    for i, bit in enumerate(bits):
+        if bit:
+            data[i // 8] |= 0x80 >> (i % 8)
+    # The reader fetches three bytes at a time, keep it inside the array
+    data += bytes(2)
+
+    index = {code: i for i, code in enumerate(order) if code is not None}
+    mapped = [f'[{glyph_label(code)}] = {index[code]}' for code in order[1:]]
+
+    out = [f'// {os.path.basename(src)}: {len(order)} glyphs, {height}px, '
+           f'{len(bits)} bits of bitmap',
+           f'static const uint8_t {name}_bits[{len(data)}] = {{',
+           c_bytes(data),
+           '};',
+           '',
+           f'static const FontGlyph {name}_metrics[{len(metrics)}] = {{',
+           '    // offset, width, rows, x_off, y_off, advance']
+    for offset, width, rows, x_off, y_off, advance, label in metrics:
+        out.append(f'    {{ {offset}, {width}, {rows}, {x_off}, {y_off}, {advance} }}, // {label}')
+    out += ['};',
+            '',
+            f'static const uint8_t {name}_map[128] = {{']
+    for i in range(0, len(mapped), 6):
+        out.append('    ' + ' '.join(m + ',' for m in mapped[i:i + 6]))
+    out += ['};',
+            '',
+            f'const Font {name} = {{',
+            f'    .width = {widest},',
+            f'    .height = {height},',
+            f'    .advance = {max(m[5] for m in metrics)},',
+            '    .orientation = FONT_BITSTREAM,',
+            '    .stride = 0,',
+            f'    .glyphs = {name}_bits,',
+            f'    .map = {name}_map,',
+            f'    .metrics = {name}_metrics,',
+            '};',
+            '']
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-o', '--output', required=True, help='C file to write')
+    parser.add_argument('fonts', nargs='+')
+    args = parser.parse_args()
+
+    parts = ['// Generated by scripts/bdf2c.py, do not edit', '',
+             '#include "text.h"', '']
+    for path in args.fonts:
+        name = 'font_' + re.sub(r'\W', '_', os.path.splitext(os.path.basename(path))[0])
+        try:
+            ascent, descent, glyphs = read_bdf(path)
+        except (OSError, ValueError, KeyError, StopIteration) as e:
+            sys.exit(f'{path}: {e}')
+        parts.append(emit(name, path, ascent, descent, glyphs))
+
+    text = '\n'.join(parts)
+    # Only touch the output when it changes, so dependants don't rebuild
+    try:
+        with open(args.output) as f:
+            if f.read() == text:
+                return
+    except OSError:
+        pass
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as f:
+        f.write(text)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+"""Generate a devicetree header for the host harness from a board overlay.
+
+The app reads its panel size and layout from the chosen "zephyr,display"
+and "tempdemo,layout" nodes. This writes a <zephyr/devicetree.h> with the
+macros Zephyr would generate for those two nodes, so the host build can
+compile the devicetree path of src/ui.c and render the layout the board
+actually ships, and compare it with the built-in one.
+
+  dt_host.py -o gen/zephyr/devicetree.h \\
+      boards/nrf52840dk_nrf52840/nrf52840dk_nrf52840.overlay \\
+      dts/bindings/tempdemo,layout.yaml
+
+Only what the app uses is covered: the overlay is parsed for nodes and
+their string and integer properties (no includes, no macros), and the
+layout binding supplies defaults and enum values the way edtlib does.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+import yaml
+
+
+class Node:
+    def __init__(self, name, parent):
+        self.name = name
+        self.parent = parent
+        self.props = {}
+        self.children = {}
+        self.labels = []
+
+    @property
+    def path(self):
+        if self.parent is None:
+            return '/'
+        return self.parent.path.rstrip('/') + '/' + self.name
+
+    def child(self, name):
+        if name not in self.children:
+            self.children[name] = Node(name, self)
+        return self.children[name]
+
+
+TOKEN = re.compile(r'''
+    (?P<space>\s+|//[^\n]*|/\*.*?\*/|\#(?:include|define|if|ifdef|ifndef|else|endif)\b[^\n]*)
+  | (?P<string>"(?:[^"\\]|\\.)*")
+  | (?P<cells><[^>]*>)
+  | (?P<bytes>\[[^\]]*\])
+  | (?P<punct>[{};=,])
+  | (?P<word>[^\s{};=,<>"\[\]][^\s{};=<>"\[\]]*)
+''', re.S | re.X)
+
+
+def tokenize(text):
+    pos = 0
+    while pos < len(text):
+        m = TOKEN.match(text, pos)
+        if not m:
+            sys.exit(f'cannot parse the overlay at "{text[pos:pos + 20]}"')
+        pos = m.end()
+        if m.lastgroup != 'space':
+            yield m.lastgroup, m.group()
+
+
+def parse_value(kind, text):
+    if kind == 'string':
+        return text[1:-1]
+    if kind == 'cells':
+        cells = text[1:-1].split()
+        return [int(c, 0) if re.fullmatch(r'-?(0x[0-9a-fA-F]+|\d+)', c) else c for c in cells]
+    return text
+
+
+def parse_dts(text):
+    """Root node of the overlay, with nodes given by reference (&label { })
+    kept apart to be merged once all labels are known."""
+    root = Node('/', None)
+    refs = []
+    tokens = list(tokenize(text))
+    i = 0
+
+    def parse_body(node):
+        nonlocal i
+        while tokens[i][1] != '}':
+            words = []
+            while tokens[i][0] == 'word' and tokens[i][1].endswith(':'):
+                words.append(tokens[i][1][:-1])
+                i += 1
+            name = tokens[i][1]
+            i += 1
+            if tokens[i][1] == '{':
+                i += 1
+                child = node.child(name)
+                child.labels += words
+                parse_body(child)
+            elif tokens[i][1] == '=':
+                i += 1
+                values = []
+                while tokens[i][1] != ';':
+                    if tokens[i][1] != ',':
+                        values.append(parse_value(*tokens[i]))
+                    i += 1
+                node.props[name] = values[0] if len(values) == 1 else values
+                i += 1
+            elif tokens[i][1] == ';':
+                node.props[name] = True
+                i += 1
+            else:
+                sys.exit(f'unexpected "{tokens[i][1]}" in {node.path}')
+        i += 2  # '}' ';'
+
+    while i < len(tokens):
+        name = tokens[i][1]
+        i += 2  # name '{'
+        if name == '/':
+            parse_body(root)
+        else:
+            node = Node(name, None)
+            parse_body(node)
+            refs.append(node)
+    return root, refs
+
+
+def walk(node):
+    yield node
+    for child in node.children.values():
+        yield from walk(child)
+
+
+def token(s):
+    return re.sub(r'[^a-z0-9]', '_', s.lower())
+
+
+def node_id(node):
+    if node.parent is None:
+        return 'DT_N'
+    return node_id(node.parent) + '_S_' + token(node.name)
+
+
+def props_from_binding(node, binding, where):
+    """Node's properties with the binding's defaults filled in, checked
+    against its types and enums"""
+    props = {}
+    for name, value in node.props.items():
+        if name in ('compatible', 'status'):
+            continue
+        if name not in binding:
+            sys.exit(f'{where}: "{name}" is not in the binding')
+        props[name] = value
+    for name, spec in binding.items():
+        if name not in props:
+            if spec.get('required'):
+                sys.exit(f'{where}: "{name}" is required')
+            if 'default' in spec:
+                props[name] = spec['default']
+                if spec['type'] == 'int':
+                    props[name] = [props[name]]
+                continue
+        if name not in props:
+            continue
+        value = props[name]
+        if spec['type'] == 'int':
+            if not (isinstance(value, list) and len(value) == 1 and isinstance(value[0], int)):
+                sys.exit(f'{where}: "{name}" has to be one integer')
+        elif spec['type'] == 'string' and not isinstance(value, str):
+            sys.exit(f'{where}: "{name}" has to be a string')
+        if 'enum' in spec:
+            v = value[0] if spec['type'] == 'int' else value
+            if v not in spec['enum']:
+                sys.exit(f'{where}: "{name}" is not one of {spec["enum"]}')
+    return props
+
+
+def emit_props(out, ident, props, binding):
+    for name, value in props.items():
+        prop = f'{ident}_P_{token(name)}'
+        if isinstance(value, str):
+            out.append(f'#define {prop} "{value}"')
+            out.append(f'#define {prop}_STRING_TOKEN {re.sub(r"[^A-Za-z0-9_]", "_", value)}')
+        elif isinstance(value, list) and len(value) == 1 and isinstance(value[0], int):
+            value = value[0]
+            out.append(f'#define {prop} {value}')
+        else:
+            continue
+        spec = binding.get(name, {})
+        if 'enum' in spec:
+            out.append(f'#define {prop}_ENUM_IDX {spec["enum"].index(value)}')
+            out.append(f'#define {prop}_ENUM_VAL_{token(str(value))}_EXISTS 1')
+        out.append(f'#define {prop}_EXISTS 1')
+
+
+# The parts of Zephyr's devicetree.h and sys/util_macro.h the app uses,
+# working on the macros below the same way
+MECHANICS = r'''
+#define _XXXX1 _YYYY,
+#define Z_DEBRACKET(...) __VA_ARGS__
+#define Z_GET_ARG2_DEBRACKET(ignore_this, val, ...) Z_DEBRACKET val
+#define Z_COND_CODE(one_or_two_args, _if_code, _else_code) \
+    Z_GET_ARG2_DEBRACKET(one_or_two_args _if_code, _else_code)
+#define Z_COND_CODE_1(_flag, _if_1_code, _else_code) \
+    Z_COND_CODE(_XXXX##_flag, _if_1_code, _else_code)
+#define COND_CODE_1(_flag, _if_1_code, _else_code) Z_COND_CODE_1(_flag, _if_1_code, _else_code)
+#define Z_IS_ENABLED3(ignore_this, val, ...) val
+#define Z_IS_ENABLED2(one_or_two_args) Z_IS_ENABLED3(one_or_two_args 1, 0)
+#define Z_IS_ENABLED1(config_macro) Z_IS_ENABLED2(_XXXX##config_macro)
+#define IS_ENABLED(config_macro) Z_IS_ENABLED1(config_macro)
+#define Z_UTIL_CAT(a, b) a##b
+#define UTIL_CAT(a, b) Z_UTIL_CAT(a, b)
+
+#define DT_CAT(a1, a2) a1##a2
+#define DT_CAT3(a1, a2, a3) a1##a2##a3
+#define DT_CAT4(a1, a2, a3, a4) a1##a2##a3##a4
+#define DT_CAT6(a1, a2, a3, a4, a5, a6) a1##a2##a3##a4##a5##a6
+#define DT_CHOSEN(prop) DT_CAT(DT_CHOSEN_, prop)
+#define DT_HAS_CHOSEN(prop) IS_ENABLED(DT_CAT3(DT_CHOSEN_, prop, _EXISTS))
+#define DT_PROP(node_id, prop) DT_CAT3(node_id, _P_, prop)
+#define DT_NODE_HAS_PROP(node_id, prop) IS_ENABLED(DT_CAT4(node_id, _P_, prop, _EXISTS))
+#define DT_PROP_OR(node_id, prop, default_value) \
+    COND_CODE_1(DT_NODE_HAS_PROP(node_id, prop), (DT_PROP(node_id, prop)), (default_value))
+#define DT_ENUM_IDX(node_id, prop) DT_CAT4(node_id, _P_, prop, _ENUM_IDX)
+#define DT_ENUM_IDX_OR(node_id, prop, default_idx_value) \
+    COND_CODE_1(DT_NODE_HAS_PROP(node_id, prop), (DT_ENUM_IDX(node_id, prop)), \
+                (default_idx_value))
+#define DT_ENUM_HAS_VALUE(node_id, prop, value) \
+    IS_ENABLED(DT_CAT6(node_id, _P_, prop, _ENUM_VAL_, value, _EXISTS))
+#define DT_STRING_TOKEN(node_id, prop) DT_CAT4(node_id, _P_, prop, _STRING_TOKEN)
+#define DT_DEP_ORD(node_id) DT_CAT(node_id, _ORD)
+#define DT_FOREACH_CHILD_STATUS_OKAY(node_id, fn) \
+    DT_CAT(node_id, _FOREACH_CHILD_STATUS_OKAY)(fn)
+'''
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-o', '--output', required=True, help='header to write')
+    parser.add_argument('overlay', help='board overlay with the chosen display and layout')
+    parser.add_argument('binding', help='dts/bindings/tempdemo,layout.yaml')
+    args = parser.parse_args()
+
+    with open(args.overlay) as f:
+        root, refs = parse_dts(f.read())
+    with open(args.binding) as f:
+        binding = yaml.safe_load(f)
+
+    labels = {label: node for node in walk(root) for label in node.labels}
+    chosen = root.children.get('chosen', Node('chosen', root)).props
+    out = ['// Generated by scripts/dt_host.py from ' + args.overlay.split('/')[-1] +
+           ', do not edit', '', '#ifndef DT_HOST_H', '#define DT_HOST_H', MECHANICS]
+
+    # Nodes given by reference only add to nodes of the board's own
+    # devicetree; the app reads none of them
+    for ref in refs:
+        if ref.name.lstrip('&') in labels:
+            labels[ref.name.lstrip('&')].props.update(ref.props)
+
+    ordinal = 0
+    for prop in ('zephyr,display', 'tempdemo,layout'):
+        target = chosen.get(prop)
+        if not (isinstance(target, str) and target.lstrip('&') in labels):
+            sys.exit(f'{args.overlay}: no chosen {prop} in the overlay')
+        node = labels[target.lstrip('&')]
+        ident = node_id(node)
+        out.append(f'#define DT_CHOSEN_{token(prop)} {ident}')
+        out.append(f'#define DT_CHOSEN_{token(prop)}_EXISTS 1')
+
+        if prop == 'zephyr,display':
+            # Sizes only, the display driver's binding is Zephyr's
+            emit_props(out, ident, {p: v for p, v in node.props.items()
+                                    if p in ('width', 'height')}, {})
+        else:
+            emit_props(out, ident, props_from_binding(node, binding.get('properties', {}),
+                                                      node.path), binding.get('properties', {}))
+            child_binding = binding['child-binding']['properties']
+            okay = [c for c in node.children.values() if c.props.get('status', 'okay') == 'okay']
+            out.append(f'#define {ident}_FOREACH_CHILD_STATUS_OKAY(fn) ' +
+                       ' '.join(f'fn({node_id(c)})' for c in okay))
+            for child in okay:
+                cid = node_id(child)
+                emit_props(out, cid, props_from_binding(child, child_binding, child.path),
+                           child_binding)
+                out.append(f'#define {cid}_ORD {ordinal}')
+                ordinal += 1
+        out.append(f'#define {ident}_ORD {ordinal}')
+        ordinal += 1
+        out.append('')
+
+    out.append('#endif // DT_HOST_H')
+    os.makedirs(os.path.dirname(args.output) or '.', exist_ok=True)
+    with open(args.output, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
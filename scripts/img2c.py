@@ -0,0 +1,289 @@
+#!/usr/bin/env python3
+"""Convert icon bitmaps into the C image tables used by draw_my_image().
+
+Reads PBM files (P1 or P4), PGM files (P2 or P5) and, when Pillow is
+installed, PNG or any other format it understands. Each input becomes one
+`const Img <name>` named after the file.
+
+  img2c.py -o icons.c assets/raindrop.pbm assets/flame.pgm
+  img2c.py --format raw -o icons.c assets/raindrop.png
+
+Formats:
+  rle    (default for bilevel input) PackBits over the SSD1680 page layout:
+         the image is cut in bands of 8 rows, each band is one byte per
+         column (top pixel in bit 7, 1 = black) and every band is
+         compressed on its own.
+  raw    row-major, 1 bit per pixel, leftmost pixel in bit 7, `pitch` bytes
+         per row.
+  gray4  (default for PGM input) four shades, from paper (0) to black (3),
+         in the same bands of 8 rows. Each band is two planes of one byte
+         per column, the high bit of every pixel's shade first, then the
+         low bit, each PackBits-compressed on its own; draw_my_image()
+         dithers them when it draws the icon.
+
+Grey input is thresholded at 50% for rle and raw (dark pixels are drawn),
+and rounded to the nearest of the four shades for gray4.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+def read_pbm(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    # Header tokens may be separated by any whitespace and comments
+    pos = 0
+    tokens = []
+    while len(tokens) < 3:
+        m = re.compile(rb'\s*(#[^\n]*\n\s*)*(\S+)').match(data, pos)
+        if not m:
+            raise ValueError(f'{path}: truncated PBM header')
+        tokens.append(m.group(2))
+        pos = m.end()
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+
+    if magic == b'P1':
+        bits = re.sub(rb'#[^\n]*', b'', data[pos:])
+        bits = [int(c) for c in bits.decode('ascii') if c in '01']
+        if len(bits) < width * height:
+            raise ValueError(f'{path}: expected {width * height} pixels, got {len(bits)}')
+        return width, height, [bits[y * width:(y + 1) * width] for y in range(height)]
+
+    if magic == b'P4':
+        pitch = (width + 7) // 8
+        raster = data[pos + 1:]
+        if len(raster) < pitch * height:
+            raise ValueError(f'{path}: truncated P4 raster')
+        return width, height, [[(raster[y * pitch + x // 8] >> (7 - x % 8)) & 1
+                                for x in range(width)] for y in range(height)]
+
+    raise ValueError(f'{path}: not a PBM file')
+
+
+def read_pgm(path):
+    """Grey levels scaled to 0 (black) .. 255 (white)"""
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    pos = 0
+    tokens = []
+    while len(tokens) < 4:
+        m = re.compile(rb'\s*(#[^\n]*\n\s*)*(\S+)').match(data, pos)
+        if not m:
+            raise ValueError(f'{path}: truncated PGM header')
+        tokens.append(m.group(2))
+        pos = m.end()
+    magic, width, height, maxval = tokens[0], int(tokens[1]), int(tokens[2]), int(tokens[3])
+
+    if magic == b'P2':
+        values = [int(v) for v in re.sub(rb'#[^\n]*', b'', data[pos:]).split()]
+    elif magic == b'P5':
+        size = 2 if maxval > 255 else 1
+        raster = data[pos + 1:]
+        values = [int.from_bytes(raster[i:i + size], 'big')
+                  for i in range(0, len(raster) - size + 1, size)]
+    else:
+        raise ValueError(f'{path}: not a PGM file')
+    if len(values) < width * height:
+        raise ValueError(f'{path}: expected {width * height} pixels, got {len(values)}')
+    return width, height, [[values[y * width + x] * 255 // maxval for x in range(width)]
+                           for y in range(height)]
+
+
+def read_grey(path):
+    if path.lower().endswith('.pbm'):
+        width, height, rows = read_pbm(path)
+        return width, height, [[0 if bit else 255 for bit in row] for row in rows]
+    if path.lower().endswith('.pgm'):
+        return read_pgm(path)
+
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit(f'{path}: Pillow is needed for non-PBM input (pip install pillow)')
+
+    img = Image.open(path).convert('L')
+    width, height = img.size
+    px = img.load()
+    return width, height, [[px[x, y] for x in range(width)] for y in range(height)]
+
+
+def read_image(path, fmt):
+    width, height, rows = read_grey(path)
+    if fmt == 'gray4':
+        return width, height, [[((255 - v) * 3 + 127) // 255 for v in row] for row in rows]
+    return width, height, [[1 if v < 128 else 0 for v in row] for row in rows]
+
+
+def pack_raw(width, height, rows):
+    pitch = (width + 7) // 8
+    out = bytearray(pitch * height)
+    for y, row in enumerate(rows):
+        for x, bit in enumerate(row):
+            if bit:
+                out[y * pitch + x // 8] |= 0x80 >> (x % 8)
+    return pitch, out
+
+
+def page_bands(width, height, rows):
+    bands = []
+    for top in range(0, height, 8):
+        band = bytearray(width)
+        for r in range(top, min(top + 8, height)):
+            for x, bit in enumerate(rows[r]):
+                if bit:
+                    band[x] |= 0x80 >> (r - top)
+        bands.append(band)
+    return bands
+
+
+def gray_bands(width, height, rows):
+    bands = []
+    for top in range(0, height, 8):
+        band = bytearray(2 * width)
+        for r in range(top, min(top + 8, height)):
+            for x, shade in enumerate(rows[r]):
+                if shade & 2:
+                    band[x] |= 0x80 >> (r - top)
+                if shade & 1:
+                    band[width + x] |= 0x80 >> (r - top)
+        bands.append(band)
+    return bands
+
+
+def packbits(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+        if run >= 2:
+            out += bytes([257 - run, data[i]])
+            i += run
+            continue
+
+        # Literal: stop where a run of two or more starts
+        start = i
+        i += 1
+        while i < len(data) and i - start < 128:
+            if i + 1 < len(data) and data[i] == data[i + 1]:
+                break
+            i += 1
+        out.append(i - start - 1)
+        out += data[start:i]
+    return out
+
+
+def unpackbits(data, length):
+    out = bytearray()
+    i = 0
+    while len(out) < length:
+        n = data[i]
+        i += 1
+        if n < 128:
+            out += data[i:i + n + 1]
+            i += n + 1
+        elif n > 128:
+            out += bytes([data[i]]) * (257 - n)
+            i += 1
+    return out, i
+
+
+def c_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ' '.join(f'0x{b:02x},' for b in data[i:i + 16]))
+    return '\n'.join(lines)
+
+
+def emit(name, src, width, height, rows, fmt):
+    if fmt == 'raw':
+        pitch, data = pack_raw(width, height, rows)
+        encoding = 'IMG_RAW'
+        layout = f'{width}x{height}px, raw, pitch {pitch}'
+        check = f'_Static_assert(sizeof({name}_data) == {pitch} * {height}, "{name}: size != pitch * height");'
+    else:
+        # Every band, or every plane of a gray band, is compressed on its own
+        pitch = width
+        if fmt == 'gray4':
+            planes = [band[i:i + width] for band in gray_bands(width, height, rows)
+                      for i in (0, width)]
+            encoding = 'IMG_GRAY4'
+            shades = '4 shades, '
+        else:
+            planes = page_bands(width, height, rows)
+            encoding = 'IMG_RLE'
+            shades = ''
+        data = bytearray()
+        for plane in planes:
+            data += packbits(plane)
+
+        # Decode again to prove the stream reproduces every band exactly
+        pos = 0
+        for plane in planes:
+            decoded, used = unpackbits(data[pos:], len(plane))
+            if decoded != plane:
+                sys.exit(f'{src}: PackBits round trip failed')
+            pos += used
+        raw_size = len(planes) * width
+        layout = f'{width}x{height}px, {shades}PackBits, {len(data)} bytes ({raw_size} unpacked)'
+        check = None
+
+    out = [f'// {os.path.basename(src)}: {layout}',
+           f'static const uint8_t {name}_data[{len(data)}] = {{',
+           c_bytes(data),
+           '};']
+    if check:
+        out.append(check)
+    out += ['',
+            f'const Img {name} = {{',
+            f'    .width = {width},',
+            f'    .height = {height},',
+            f'    .pitch = {pitch},',
+            f'    .img_data = {name}_data,',
+            f'    .encoding = {encoding},',
+            f'    .data_size = sizeof({name}_data),',
+            '};',
+            '']
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-o', '--output', required=True, help='C file to write')
+    parser.add_argument('--format', choices=('rle', 'raw', 'gray4'),
+                        help='rle for bilevel input and gray4 for PGM when left out')
+    parser.add_argument('images', nargs='+')
+    args = parser.parse_args()
+
+    parts = ['// Generated by scripts/img2c.py, do not edit', '',
+             '#include "my_image.h"', '']
+    for path in args.images:
+        name = re.sub(r'\W', '_', os.path.splitext(os.path.basename(path))[0])
+        fmt = args.format or ('gray4' if path.lower().endswith('.pgm') else 'rle')
+        width, height, rows = read_image(path, fmt)
+        if width <= 0 or height <= 0 or any(len(r) != width for r in rows):
+            sys.exit(f'{path}: inconsistent image size')
+        parts.append(emit(name, path, width, height, rows, fmt))
+
+    text = '\n'.join(parts)
+    # Only touch the output when it changes, so dependants don't rebuild
+    try:
+        with open(args.output) as f:
+            if f.read() == text:
+                return
+    except OSError:
+        pass
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as f:
+        f.write(text)
+
+
+if __name__ == '__main__':
+    main()
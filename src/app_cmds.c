@@ -0,0 +1,267 @@
+#include "centi.h"
+#include "epd.h"
+#include "framebuffer.h"
+#include "history.h"
+#include "render.h"
+#include "sensors.h"
+#include "text_cache.h"
+#include "tuning.h"
+#include "ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/base64.h>
+
+// Bytes per line of a frame dump, 64 characters of base64
+#define DUMP_LINE 48
+
+// Longest a frame can take to reach the panel, a full refresh included
+#define FRAME_TIMEOUT K_SECONDS(10)
+
+static const char *const field_names[UI_FIELD_COUNT] = {
+    [UI_TEMP_C] = "temp",
+    [UI_TEMP_F] = "temp_f",
+    [UI_HUMIDITY] = "humidity",
+    [UI_HEAT_INDEX_C] = "heat_index",
+    [UI_DEW_POINT_C] = "dew_point",
+};
+
+static int field_by_name(const char *name) {
+    for (int f = 0; f < UI_FIELD_COUNT; f++) {
+        if (strcmp(name, field_names[f]) == 0) {
+            return f;
+        }
+    }
+    return -ENOENT;
+}
+
+static void print_history(const struct shell *sh, enum history_channel channel,
+                          const char *name, const char *unit) {
+    struct history_stats s;
+    char min[12], max[12], mean[12], trend[12];
+
+    render_lock_history();
+    int err = history_stats(channel, &s);
+    render_unlock_history();
+    if (err) {
+        return;
+    }
+    shell_print(sh, "  %-11s min %s max %s mean %s %s, trend %s %s/h", name,
+                centi_str(min, sizeof(min), s.min), centi_str(max, sizeof(max), s.max),
+                centi_str(mean, sizeof(mean), s.mean), unit,
+                centi_str(trend, sizeof(trend), s.trend_per_hour), unit);
+}
+
+static int cmd_readings(const struct shell *sh, size_t argc, char **argv) {
+    char a[12], b[12], c[12];
+
+    for (int l = 0; l < SENSORS_LOCATIONS; l++) {
+        struct reading r;
+        struct comfort cf;
+
+        if (render_get_latest(l, &r, &cf) != 0) {
+            shell_print(sh, "location %d: no reading yet", l);
+            continue;
+        }
+        shell_print(sh, "location %d%s%s%s, %u s ago", l, *r.name ? " (" : "", r.name,
+                    *r.name ? ")" : "", (uint32_t)((k_uptime_get() - r.uptime_ms) / 1000));
+        shell_print(sh, "  sensor      %s C, %s %%RH",
+                    centi_str(a, sizeof(a), sensor_value_to_centi(&r.temp)),
+                    centi_str(b, sizeof(b), sensor_value_to_centi(&r.humidity)));
+        shell_print(sh, "  shown       %s C (%s F), %s %%RH",
+                    centi_str(a, sizeof(a), q16_to_centi(cf.temp_c)),
+                    centi_str(b, sizeof(b), q16_to_centi(cf.temp_f)),
+                    centi_str(c, sizeof(c), q16_to_centi(cf.humidity)));
+        shell_print(sh, "  heat index  %s C, dew point %s C",
+                    centi_str(a, sizeof(a), q16_to_centi(cf.heat_index_c)),
+                    centi_str(b, sizeof(b), q16_to_centi(cf.dew_point_c)));
+    }
+
+    // Statistics over the sample ring, which follows the primary location
+    render_lock_history();
+    int count = history_count();
+    render_unlock_history();
+    shell_print(sh, "history: %d samples", count);
+    print_history(sh, HISTORY_TEMP, "temperature", "C");
+    print_history(sh, HISTORY_HUMIDITY, "humidity", "%RH");
+    return 0;
+}
+
+// base64 of a byte stream, printed DUMP_LINE bytes to a line
+struct dump {
+    const struct shell *sh;
+    uint8_t buf[DUMP_LINE];
+    size_t len;
+};
+
+static void dump_flush(struct dump *d) {
+    char line[DUMP_LINE / 3 * 4 + 1];
+    size_t olen;
+
+    if (d->len > 0 && base64_encode((uint8_t *)line, sizeof(line), &olen, d->buf, d->len) == 0) {
+        shell_print(d->sh, "%s", line);
+    }
+    d->len = 0;
+}
+
+static void dump_bytes(struct dump *d, const uint8_t *data, size_t n) {
+    while (n--) {
+        d->buf[d->len++] = *data++;
+        if (d->len == DUMP_LINE) {
+            dump_flush(d);
+        }
+    }
+}
+
+// Print the frame on the panel as a binary PBM ("P4"): rows of black-is-1
+// bits, leftmost pixel in the MSB. Decode on the host with
+// "base64 -d > frame.pbm".
+static int cmd_frame(const struct shell *sh, size_t argc, char **argv) {
+    struct dump d = { .sh = sh };
+    uint8_t row[(DISPLAY_WIDTH + 7) / 8];
+    char header[24];
+
+    // Convert from the panel's column layout row by row, straight from
+    // the frame the renderer keeps; it is held only while that runs
+    const struct framebuffer *fb = epd_hold_frame(FRAME_TIMEOUT);
+    if (!fb) {
+        shell_error(sh, "No frame yet");
+        return -ENODATA;
+    }
+    int n = snprintf(header, sizeof(header), "P4\n%d %d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    dump_bytes(&d, (const uint8_t *)header, n);
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        fb_pbm_row(fb->data, y, row);
+        dump_bytes(&d, row, sizeof(row));
+    }
+    epd_release_frame(fb);
+    dump_flush(&d);
+    return 0;
+}
+
+static int cmd_period(const struct shell *sh, size_t argc, char **argv) {
+    uint32_t min_ms, max_ms;
+
+    if (argc > 1) {
+        min_ms = strtoul(argv[1], NULL, 10);
+        max_ms = argc > 2 ? strtoul(argv[2], NULL, 10) : min_ms;
+        if (tuning_set_period(min_ms, max_ms) != 0) {
+            shell_error(sh, "need 0 < min <= max");
+            return -EINVAL;
+        }
+    }
+    tuning_get_period(&min_ms, &max_ms);
+    shell_print(sh, "sample period %u to %u ms", min_ms, max_ms);
+    return 0;
+}
+
+static int cmd_threshold(const struct shell *sh, size_t argc, char **argv) {
+    char buf[12];
+
+    if (argc == 3) {
+        int field = field_by_name(argv[1]);
+        int32_t centi;
+        q16_t min;
+
+        if (field < 0 || ui_get_threshold(field, &min) != 0) {
+            shell_error(sh, "No icon depends on %s", argv[1]);
+            return -ENOENT;
+        }
+        if (parse_centi(argv[2], &centi) != 0) {
+            shell_error(sh, "Not a number: %s", argv[2]);
+            return -EINVAL;
+        }
+        tuning_set_threshold(field, (q16_t)(((int64_t)centi << 16) / 100));
+    } else if (argc != 1) {
+        shell_error(sh, "Give a field and its value");
+        return -EINVAL;
+    }
+
+    // Thresholds set here win over the layout's
+    for (int f = 0; f < UI_FIELD_COUNT; f++) {
+        q16_t min;
+        if (tuning_get_threshold(f, &min) || ui_get_threshold(f, &min) == 0) {
+            shell_print(sh, "%-11s icon from %s", field_names[f],
+                        centi_str(buf, sizeof(buf), q16_to_centi(min)));
+        }
+    }
+    return 0;
+}
+
+static int cmd_refresh_show(const struct shell *sh, size_t argc, char **argv) {
+    int partials = tuning_full_refresh_interval();
+
+    if (partials == 0) {
+        shell_print(sh, "full refresh for every frame");
+    } else {
+        shell_print(sh, "full refresh after %d partial ones", partials);
+    }
+    return 0;
+}
+
+static int cmd_refresh_interval(const struct shell *sh, size_t argc, char **argv) {
+    char *end;
+    long partials = strtol(argv[1], &end, 10);
+
+    if (*end != '\0' || partials < 0 || partials > 1000) {
+        shell_error(sh, "interval must be 0 to 1000");
+        return -EINVAL;
+    }
+    tuning_set_full_refresh_interval((int)partials);
+    return cmd_refresh_show(sh, 1, argv);
+}
+
+static int cmd_refresh_full(const struct shell *sh, size_t argc, char **argv) {
+    tuning_request_full_refresh();
+    shell_print(sh, "Full refresh on the next frame");
+    return 0;
+}
+
+static int cmd_quiet(const struct shell *sh, size_t argc, char **argv) {
+    if (argc > 1) {
+        if (strcmp(argv[1], "on") == 0) {
+            tuning_set_quiet(true);
+        } else if (strcmp(argv[1], "off") == 0) {
+            tuning_set_quiet(false);
+        } else {
+            shell_error(sh, "on or off");
+            return -EINVAL;
+        }
+    }
+    shell_print(sh, "per-cycle prints %s", tuning_quiet() ? "off" : "on");
+    return 0;
+}
+
+static int cmd_text_cache(const struct shell *sh, size_t argc, char **argv) {
+    struct text_cache_stats s;
+
+    // Counters written by the render thread, each is read in one go
+    text_cache_get_stats(&s);
+    shell_print(sh, "label cache: %u hits, %u misses, %u evictions", s.hits, s.misses,
+                s.evictions);
+    shell_print(sh, "%u glyphs not rendered, %u of %u bytes used", s.glyphs_saved, s.bytes_used,
+                TEXT_CACHE_SIZE);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(refresh_cmds,
+    SHELL_CMD_ARG(interval, NULL, "Partial refreshes between full ones, 0 for none <n>",
+                  cmd_refresh_interval, 2, 0),
+    SHELL_CMD(full, NULL, "Make the next frame a full refresh", cmd_refresh_full),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((tempdemo), readings, NULL, "Newest readings, derived values and history",
+                 cmd_readings, 1, 0);
+SHELL_SUBCMD_ADD((tempdemo), frame, NULL, "Dump the frame on the panel as base64 PBM",
+                 cmd_frame, 1, 0);
+SHELL_SUBCMD_ADD((tempdemo), period, NULL, "Sample period limits [min_ms [max_ms]]",
+                 cmd_period, 1, 2);
+SHELL_SUBCMD_ADD((tempdemo), threshold, NULL, "Icon thresholds [field value]",
+                 cmd_threshold, 1, 2);
+SHELL_SUBCMD_ADD((tempdemo), refresh, &refresh_cmds, "Full refresh policy",
+                 cmd_refresh_show, 1, 0);
+SHELL_SUBCMD_ADD((tempdemo), textcache, NULL, "Label cache counters", cmd_text_cache, 1, 0);
+SHELL_SUBCMD_ADD((tempdemo), quiet, NULL, "Per-cycle prints [on|off]", cmd_quiet, 1, 1);
@@ -0,0 +1,6 @@
+#include <zephyr/shell/shell.h>
+
+// Root of the app's shell commands; modules add theirs with
+// SHELL_SUBCMD_ADD((tempdemo), ...)
+SHELL_SUBCMD_SET_CREATE(tempdemo_cmds, (tempdemo));
+SHELL_CMD_REGISTER(tempdemo, &tempdemo_cmds, "tempDemo commands", NULL);
@@ -0,0 +1,76 @@
+#include "bigtext.h"
+#include "framebuffer.h"
+#include <stdint.h>
+
+// Each bit of a nibble repeated s times: nibble n becomes 4*s bits
+#define SPREAD_BIT(n, b, s) ((((n) >> (b)) & 1) * ((1u << (s)) - 1) << ((b) * (s)))
+#define SPREAD(n, s) \
+    (SPREAD_BIT(n, 3, s) | SPREAD_BIT(n, 2, s) | SPREAD_BIT(n, 1, s) | SPREAD_BIT(n, 0, s))
+#define SPREAD_ROW(s) { \
+    SPREAD(0, s), SPREAD(1, s), SPREAD(2, s), SPREAD(3, s), \
+    SPREAD(4, s), SPREAD(5, s), SPREAD(6, s), SPREAD(7, s), \
+    SPREAD(8, s), SPREAD(9, s), SPREAD(10, s), SPREAD(11, s), \
+    SPREAD(12, s), SPREAD(13, s), SPREAD(14, s), SPREAD(15, s) }
+
+// spread[s - 2][n]: vertical scaling looks pixels up four at a time
+static const uint16_t spread[BIGTEXT_MAX_SCALE - 1][16] = {
+    SPREAD_ROW(2),
+    SPREAD_ROW(3),
+    SPREAD_ROW(4),
+};
+
+// Stretch a column word (top pixel in bit 15) to 16 * scale rows, top
+// pixel in bit 63
+static uint64_t scale_column(uint16_t col, int scale) {
+    const uint16_t *table = spread[scale - 2];
+    uint64_t out = 0;
+
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        out = out << (4 * scale) | table[(col >> shift) & 0xF];
+    }
+    return out << (64 - 16 * scale);
+}
+
+static int clamp_scale(int scale) {
+    return scale < 1 ? 1 : scale > BIGTEXT_MAX_SCALE ? BIGTEXT_MAX_SCALE : scale;
+}
+
+void bigtext_draw_char(const Font *font, char c, int x, int y, int scale) {
+    uint16_t cols[FONT_MAX_WIDTH];
+    FontGlyph box;
+
+    scale = clamp_scale(scale);
+    if (scale == 1) {
+        draw_char(font, c, x, y);
+        return;
+    }
+
+    // Horizontal scaling is free: every source column becomes one run of
+    // scale identical framebuffer columns
+    text_glyph(font, c, cols, &box);
+    x += box.x_off * scale;
+    y += box.y_off * scale;
+    for (int col = 0; col < box.width; col++) {
+        if (cols[col]) {
+            fb_blit_column_run(x + col * scale, y, scale_column(cols[col], scale),
+                               box.rows * scale, scale);
+        }
+    }
+}
+
+void bigtext_draw_string(const Font *font, const char *text, int x, int y, int scale) {
+    scale = clamp_scale(scale);
+    if (scale == 1) {
+        draw_string(font, text, x, y);
+        return;
+    }
+    while (*text && x < DISPLAY_WIDTH) {
+        bigtext_draw_char(font, *text, x, y, scale);
+        x += text_advance(font, *text) * scale;
+        text++;
+    }
+}
+
+int bigtext_width(const Font *font, const char *text, int scale) {
+    return text_width(font, text) * clamp_scale(scale);
+}
@@ -0,0 +1,28 @@
+#ifndef BIGTEXT_H
+#define BIGTEXT_H
+
+#include "text.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest integer scale bigtext_draw_*() take; the scaled glyph has to
+// fit fb_blit_column_run(), so font height * scale <= 56 as well
+#define BIGTEXT_MAX_SCALE 4
+
+// Draw c from font at scale times its size, top left corner at (x, y).
+// Scale 1 is plain draw_char().
+void bigtext_draw_char(const Font *font, char c, int x, int y, int scale);
+
+// Draw a string on one line at scale times the font's size
+void bigtext_draw_string(const Font *font, const char *text, int x, int y, int scale);
+
+// Width in pixels bigtext_draw_string() advances over for text
+int bigtext_width(const Font *font, const char *text, int scale);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BIGTEXT_H
@@ -0,0 +1,38 @@
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include <stdint.h>
+
+// Reverse the bit order of a byte (bit 0 <-> bit 7)
+static inline uint8_t bit_reverse8(uint8_t b) {
+    static const uint8_t nibble[16] = {
+        0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+        0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF,
+    };
+    return (nibble[b & 0x0F] << 4) | nibble[b >> 4];
+}
+
+// Transpose an 8x8 bit matrix (Hacker's Delight, transpose8rS32).
+// in[r] is row r with column 0 in bit 7; out[c] is column c with row 0
+// in bit 7, which is exactly one byte of the SSD1680's vertical layout.
+static inline void transpose8x8(const uint8_t in[8], uint8_t out[8]) {
+    uint32_t x = ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) |
+                 ((uint32_t)in[2] << 8) | in[3];
+    uint32_t y = ((uint32_t)in[4] << 24) | ((uint32_t)in[5] << 16) |
+                 ((uint32_t)in[6] << 8) | in[7];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA; x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA; y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    out[0] = x >> 24; out[1] = x >> 16; out[2] = x >> 8; out[3] = x;
+    out[4] = y >> 24; out[5] = y >> 16; out[6] = y >> 8; out[7] = y;
+}
+
+#endif // BITOPS_H
@@ -0,0 +1,269 @@
+#include "ble_ess.h"
+#include "ess_history.h"
+#include "render.h"
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+LOG_MODULE_REGISTER(ble_ess);
+
+#define PACKET_MAX      (CONFIG_BT_L2CAP_TX_MTU - 3)
+#define RETRY_DELAY     K_MSEC(20)
+
+// Vendor characteristic for the history transfer
+#define BT_UUID_HISTORY \
+    BT_UUID_DECLARE_128(BT_UUID_128_ENCODE(0x6f1c0001, 0x6d70, 0x4465, 0x6d6f, 0x746574656d70))
+
+static const struct bt_data ad[] = {
+    BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+    BT_DATA_BYTES(BT_DATA_UUID16_ALL, BT_UUID_16_ENCODE(BT_UUID_ESS_VAL)),
+};
+
+static const struct bt_data sd[] = {
+    BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME, sizeof(CONFIG_BT_DEVICE_NAME) - 1),
+};
+
+// Values as the characteristics encode them, in CPU byte order
+static struct {
+    int16_t temp;
+    uint16_t humidity;
+    int8_t heat_index;
+} current;
+
+static bool notify_temp;
+static bool notify_humidity;
+static bool notify_heat_index;
+static bool notify_history;
+
+// History transfer state. Requests and disconnects arrive on the
+// Bluetooth RX thread, the transfer itself runs on the system work
+// queue; stream_lock covers the four fields below. stream_next is the
+// number of the next sample to send (see history_total()), stream_id
+// tells one transfer from the next.
+static struct k_work_delayable stream_work;
+static K_MUTEX_DEFINE(stream_lock);
+static struct bt_conn *stream_conn;
+static uint32_t stream_next;
+static uint32_t stream_id;
+static bool streaming;
+static atomic_t in_flight;
+
+static ssize_t read_temp(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                         void *buf, uint16_t len, uint16_t offset) {
+    int16_t value = sys_cpu_to_le16(current.temp);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &value, sizeof(value));
+}
+
+static ssize_t read_humidity(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                             void *buf, uint16_t len, uint16_t offset) {
+    uint16_t value = sys_cpu_to_le16(current.humidity);
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &value, sizeof(value));
+}
+
+static ssize_t read_heat_index(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                               void *buf, uint16_t len, uint16_t offset) {
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &current.heat_index,
+                             sizeof(current.heat_index));
+}
+
+static ssize_t write_history(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                             const void *buf, uint16_t len, uint16_t offset, uint8_t flags) {
+    if (offset != 0 || len != sizeof(uint32_t)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+    if (!notify_history) {
+        return BT_GATT_ERR(BT_ATT_ERR_CCC_IMPROPER_CONF);
+    }
+
+    render_lock_history();
+    uint32_t next = ess_history_first_after(sys_get_le32(buf));
+    render_unlock_history();
+
+    k_mutex_lock(&stream_lock, K_FOREVER);
+    if (streaming) {
+        k_mutex_unlock(&stream_lock);
+        return BT_GATT_ERR(BT_ATT_ERR_PROCEDURE_IN_PROGRESS);
+    }
+    stream_conn = bt_conn_ref(conn);
+    stream_next = next;
+    stream_id++;
+    streaming = true;
+    k_mutex_unlock(&stream_lock);
+
+    k_work_schedule(&stream_work, K_NO_WAIT);
+    return len;
+}
+
+#define CCC_CHANGED(flag) \
+    static void flag##_changed(const struct bt_gatt_attr *attr, uint16_t value) { \
+        flag = value == BT_GATT_CCC_NOTIFY; \
+    }
+CCC_CHANGED(notify_temp)
+CCC_CHANGED(notify_humidity)
+CCC_CHANGED(notify_heat_index)
+CCC_CHANGED(notify_history)
+
+BT_GATT_SERVICE_DEFINE(ess_svc,
+    BT_GATT_PRIMARY_SERVICE(BT_UUID_ESS),
+    BT_GATT_CHARACTERISTIC(BT_UUID_TEMPERATURE, BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_READ, read_temp, NULL, NULL),
+    BT_GATT_CCC(notify_temp_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_HUMIDITY, BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_READ, read_humidity, NULL, NULL),
+    BT_GATT_CCC(notify_humidity_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_HEAT_INDEX, BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_READ, read_heat_index, NULL, NULL),
+    BT_GATT_CCC(notify_heat_index_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+    BT_GATT_CHARACTERISTIC(BT_UUID_HISTORY, BT_GATT_CHRC_WRITE | BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_WRITE, NULL, write_history, NULL),
+    BT_GATT_CCC(notify_history_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+// Value attributes: service, then declaration, value and CCC per characteristic
+#define ATTR_TEMP       (&ess_svc.attrs[2])
+#define ATTR_HUMIDITY   (&ess_svc.attrs[5])
+#define ATTR_HEAT_INDEX (&ess_svc.attrs[8])
+#define ATTR_HISTORY    (&ess_svc.attrs[11])
+
+// Call with stream_lock held
+static void stream_end(void) {
+    streaming = false;
+    bt_conn_unref(stream_conn);
+    stream_conn = NULL;
+}
+
+static void stream_sent(struct bt_conn *conn, void *user_data) {
+    // The count is reset on disconnect, late completions find it at 0
+    if (atomic_get(&in_flight) > 0) {
+        atomic_dec(&in_flight);
+    }
+    k_work_schedule(&stream_work, K_NO_WAIT);
+}
+
+// Send one notification of the transfer; false once there is nothing
+// more to do for now. The packet is built and sent on a reference of
+// our own and without stream_lock held (packing waits for the history
+// lock), so a disconnect in between only makes the send fail and is
+// noticed when the position is stored.
+static bool stream_one(uint8_t *buf, size_t buf_size) {
+    k_mutex_lock(&stream_lock, K_FOREVER);
+    if (!streaming) {
+        k_mutex_unlock(&stream_lock);
+        return false;
+    }
+    struct bt_conn *conn = bt_conn_ref(stream_conn);
+    uint32_t id = stream_id;
+    uint32_t next = stream_next;
+    k_mutex_unlock(&stream_lock);
+
+    uint16_t size = MIN(bt_gatt_get_mtu(conn) - 3, buf_size);
+    render_lock_history();
+    uint16_t len = ess_history_pack(buf, size, &next);
+    render_unlock_history();
+
+    struct bt_gatt_notify_params params = {
+        .attr = ATTR_HISTORY,
+        .data = buf,
+        .len = len,
+        .func = stream_sent,
+    };
+    atomic_inc(&in_flight);
+    int err = bt_gatt_notify_cb(conn, &params);
+    if (err) {
+        atomic_dec(&in_flight);
+    }
+
+    bool more = false;
+    k_mutex_lock(&stream_lock, K_FOREVER);
+    if (streaming && stream_id == id) {
+        if (err == -ENOMEM) {
+            // Out of buffers: try the same packet again shortly
+            k_work_schedule(&stream_work, RETRY_DELAY);
+        } else if (err) {
+            LOG_WRN("History transfer stopped (%d)", err);
+            stream_end();
+        } else if (buf[0] == 0) {
+            stream_end();
+        } else {
+            stream_next = next;
+            more = true;
+        }
+    }
+    k_mutex_unlock(&stream_lock);
+    bt_conn_unref(conn);
+    return more;
+}
+
+// Keep up to APP_BLE_HISTORY_IN_FLIGHT notifications queued, so several
+// go out in every connection event
+static void stream_handler(struct k_work *work) {
+    static uint8_t buf[PACKET_MAX];
+
+    while (atomic_get(&in_flight) < CONFIG_APP_BLE_HISTORY_IN_FLIGHT &&
+           stream_one(buf, sizeof(buf))) {
+    }
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason) {
+    k_mutex_lock(&stream_lock, K_FOREVER);
+    if (streaming && conn == stream_conn) {
+        stream_end();
+        atomic_set(&in_flight, 0);
+    }
+    k_mutex_unlock(&stream_lock);
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+    .disconnected = disconnected,
+};
+
+static void notify(bool enabled, const struct bt_gatt_attr *attr, const void *data, uint16_t len) {
+    if (enabled) {
+        // -ENOTCONN just means nobody is listening right now
+        bt_gatt_notify(NULL, attr, data, len);
+    }
+}
+
+void ble_ess_update(const struct comfort *comfort) {
+    int16_t temp = (int16_t)q16_to_centi(comfort->temp_c);
+    uint16_t humidity = (uint16_t)q16_to_centi(comfort->humidity);
+    int32_t centi = q16_to_centi(comfort->heat_index_c);
+    int8_t heat_index = (int8_t)((centi + (centi < 0 ? -50 : 50)) / 100);
+
+    if (temp != current.temp) {
+        current.temp = temp;
+        temp = sys_cpu_to_le16(temp);
+        notify(notify_temp, ATTR_TEMP, &temp, sizeof(temp));
+    }
+    if (humidity != current.humidity) {
+        current.humidity = humidity;
+        humidity = sys_cpu_to_le16(humidity);
+        notify(notify_humidity, ATTR_HUMIDITY, &humidity, sizeof(humidity));
+    }
+    if (heat_index != current.heat_index) {
+        current.heat_index = heat_index;
+        notify(notify_heat_index, ATTR_HEAT_INDEX, &heat_index, sizeof(heat_index));
+    }
+}
+
+int ble_ess_init(void) {
+    k_work_init_delayable(&stream_work, stream_handler);
+
+    int err = bt_enable(NULL);
+    if (err) {
+        LOG_ERR("Bluetooth init failed (%d)", err);
+        return err;
+    }
+
+    err = bt_le_adv_start(BT_LE_ADV_CONN, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
+    if (err) {
+        LOG_ERR("Advertising failed to start (%d)", err);
+        return err;
+    }
+    LOG_INF("Advertising as %s", CONFIG_BT_DEVICE_NAME);
+    return 0;
+}
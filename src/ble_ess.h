@@ -0,0 +1,34 @@
+#ifndef BLE_ESS_H
+#define BLE_ESS_H
+
+#include "comfort.h"
+
+// Environmental Sensing Service over Bluetooth LE. The device advertises
+// as a connectable peripheral and exposes:
+//
+//   Temperature (0x2A6E)  sint16, 0.01 C      read, notify
+//   Humidity (0x2A6F)     uint16, 0.01 %      read, notify
+//   Heat Index (0x2A7A)   sint8, 1 C          read, notify
+//   History (vendor)      write, notify
+//
+// The measurements are notified when their value changes at the
+// characteristic's resolution, not on every sample.
+//
+// History transfer: after subscribing, the client writes a uint32 (LE)
+// uptime in seconds to the History characteristic. Every sample in the
+// ring newer than that is then sent oldest first, packed into as few
+// notifications as the negotiated ATT MTU allows:
+//
+//   uint8 count, then count records of
+//   uint32 uptime_s, sint16 temperature (0.01 C), uint16 humidity (0.01 %)
+//
+// A notification with count 0 ends the transfer. Writing 0 fetches the
+// whole ring; writing the last uptime received resumes.
+
+// Start Bluetooth and advertising
+int ble_ess_init(void);
+
+// Publish new values; called by the render thread on every change
+void ble_ess_update(const struct comfort *comfort);
+
+#endif // BLE_ESS_H
@@ -0,0 +1,45 @@
+#include "centi.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+const char *centi_str(char *buf, size_t size, int32_t centi) {
+    const char *sign = centi < 0 ? "-" : "";
+    uint32_t magnitude = centi < 0 ? 0u - (uint32_t)centi : (uint32_t)centi;
+
+    snprintf(buf, size, "%s%u.%02u", sign, (unsigned)(magnitude / 100),
+             (unsigned)(magnitude % 100));
+    return buf;
+}
+
+int parse_centi(const char *s, int32_t *centi) {
+    bool negative = *s == '-';
+    int32_t value = 0;
+    int digits = 0;
+    int places = -1;
+
+    if (negative) {
+        s++;
+    }
+    for (; *s; s++) {
+        if (*s == '.' && places < 0 && digits > 0) {
+            places = 0;
+        } else if (*s >= '0' && *s <= '9' && places < 2 && value < 1000000) {
+            value = value * 10 + (*s - '0');
+            digits++;
+            if (places >= 0) {
+                places++;
+            }
+        } else {
+            return -EINVAL;
+        }
+    }
+    if (digits == 0 || places == 0) {
+        return -EINVAL;
+    }
+    for (places = places < 0 ? 0 : places; places < 2; places++) {
+        value *= 10;
+    }
+    *centi = negative ? -value : value;
+    return 0;
+}
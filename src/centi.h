@@ -0,0 +1,24 @@
+#ifndef CENTI_H
+#define CENTI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Hundredths (of a degree, a percent) as the shell prints and reads them
+
+// As a decimal with two places, e.g. -5 -> "-0.05"; returns buf
+const char *centi_str(char *buf, size_t size, int32_t centi);
+
+// Parse a decimal with up to two places, e.g. "26", "-1.5", "45.25".
+// There has to be a digit on each side of a point. Returns 0 or -EINVAL.
+int parse_centi(const char *s, int32_t *centi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CENTI_H
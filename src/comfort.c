@@ -0,0 +1,150 @@
+#include "comfort.h"
+
+// Coefficients in Q32 so the small high-order terms keep their precision
+#define Q32(x) ((int64_t)((x) * 4294967296.0))
+
+#define LN2_Q16 45426  // ln(2)
+
+q16_t q16_from_sensor_value(const struct sensor_value *v) {
+    // val2 is in millionths and has the same sign as val1
+    return (q16_t)((int64_t)v->val1 * Q16_ONE + (int64_t)v->val2 * Q16_ONE / 1000000);
+}
+
+static q16_t q16_mul(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a * b) >> 16);
+}
+
+static q16_t q16_div(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a << 16) / b);
+}
+
+// Q32 coefficient times a Q16 value, result in Q16
+static int64_t coef_mul(int64_t coef_q32, int64_t v_q16) {
+    return (coef_q32 * v_q16) >> 32;
+}
+
+static uint32_t isqrt64(uint64_t v) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)root;
+}
+
+static q16_t q16_sqrt(q16_t v) {
+    return v <= 0 ? 0 : (q16_t)isqrt64((uint64_t)v << 16);
+}
+
+// Natural log of a positive Q16 value: the integer part of log2 comes
+// from the position of the top bit, the fraction from repeated squaring
+static q16_t q16_ln(q16_t v) {
+    int32_t int_part = 0;
+    uint32_t x = (uint32_t)v;
+
+    while (x >= 2u * Q16_ONE) {
+        x >>= 1;
+        int_part++;
+    }
+    while (x < Q16_ONE) {
+        x <<= 1;
+        int_part--;
+    }
+
+    // x is now in [1, 2)
+    int32_t frac = 0;
+    for (int bit = Q16_ONE >> 1; bit; bit >>= 1) {
+        x = (uint32_t)(((uint64_t)x * x) >> 16);
+        if (x >= 2u * Q16_ONE) {
+            x >>= 1;
+            frac |= bit;
+        }
+    }
+    return q16_mul(int_part * Q16_ONE + frac, LN2_Q16);
+}
+
+// NWS heat index (Rothfusz regression with the low/high humidity
+// adjustments, Steadman's simple formula below 80 F). T in F, RH in %.
+static q16_t heat_index_f(q16_t t, q16_t rh) {
+    // Simple formula first; averaged with T it decides which one applies
+    q16_t simple = (t + Q16_FROM_INT(61) + q16_mul(t - Q16_FROM_INT(68), Q16_ONE * 6 / 5) +
+                    q16_mul(rh, Q16_ONE * 94 / 1000)) / 2;
+    if ((simple + t) / 2 < Q16_FROM_INT(80)) {
+        return simple;
+    }
+
+    int64_t t2 = ((int64_t)t * t) >> 16;
+    int64_t r2 = ((int64_t)rh * rh) >> 16;
+    int64_t tr = ((int64_t)t * rh) >> 16;
+    int64_t hi = -Q32(42.379) >> 16;
+
+    hi += coef_mul(Q32(2.04901523), t);
+    hi += coef_mul(Q32(10.14333127), rh);
+    hi -= coef_mul(Q32(0.22475541), tr);
+    hi -= coef_mul(Q32(0.00683783), t2);
+    hi -= coef_mul(Q32(0.05481717), r2);
+    hi += coef_mul(Q32(0.00122874), (t2 * rh) >> 16);
+    hi += coef_mul(Q32(0.00085282), (tr * rh) >> 16);
+    hi -= coef_mul(Q32(0.00000199), (tr * tr) >> 16);
+
+    if (rh < Q16_FROM_INT(13) && t >= Q16_FROM_INT(80) && t <= Q16_FROM_INT(112)) {
+        // Dry air: subtract ((13 - RH) / 4) * sqrt((17 - |T - 95|) / 17)
+        q16_t dt = t - Q16_FROM_INT(95);
+        q16_t root = q16_sqrt((Q16_FROM_INT(17) - (dt < 0 ? -dt : dt)) / 17);
+        hi -= q16_mul((Q16_FROM_INT(13) - rh) / 4, root);
+    } else if (rh > Q16_FROM_INT(85) && t >= Q16_FROM_INT(80) && t <= Q16_FROM_INT(87)) {
+        // Humid air: add ((RH - 85) / 10) * ((87 - T) / 5)
+        hi += q16_mul((rh - Q16_FROM_INT(85)) / 10, (Q16_FROM_INT(87) - t) / 5);
+    }
+    return (q16_t)hi;
+}
+
+// Magnus formula with the Sonntag (1990) constants, T in C, RH in %
+static q16_t dew_point_c(q16_t t, q16_t rh) {
+    const q16_t b = 1154744;       // 17.62
+    const q16_t c = 15933112;      // 243.12 C
+    const q16_t min_rh = Q16_ONE;  // ln(0) is undefined, clamp at 1 %
+
+    q16_t gamma = q16_ln(q16_div(rh < min_rh ? min_rh : rh, Q16_FROM_INT(100))) +
+                  q16_div(q16_mul(b, t), c + t);
+    return q16_div(q16_mul(c, gamma), b - gamma);
+}
+
+static q16_t c_to_f(q16_t c) {
+    return c * 9 / 5 + Q16_FROM_INT(32);
+}
+
+static q16_t f_to_c(q16_t f) {
+    return (f - Q16_FROM_INT(32)) * 5 / 9;
+}
+
+bool comfort_update(struct comfort *c, const struct sensor_value *temp,
+                    const struct sensor_value *humidity) {
+    if (c->valid &&
+        c->temp_in.val1 == temp->val1 && c->temp_in.val2 == temp->val2 &&
+        c->humidity_in.val1 == humidity->val1 && c->humidity_in.val2 == humidity->val2) {
+        return false;
+    }
+
+    c->temp_in = *temp;
+    c->humidity_in = *humidity;
+    c->valid = true;
+
+    c->temp_c = q16_from_sensor_value(temp);
+    c->humidity = q16_from_sensor_value(humidity);
+    c->temp_f = c_to_f(c->temp_c);
+    c->heat_index_f = heat_index_f(c->temp_f, c->humidity);
+    c->heat_index_c = f_to_c(c->heat_index_f);
+    c->dew_point_c = dew_point_c(c->temp_c, c->humidity);
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef COMFORT_H
+#define COMFORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/drivers/sensor.h>
+#include "q16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Derived comfort values, all in Q16. The inputs they were computed from
+// are kept so comfort_update() can tell when nothing changed.
+struct comfort {
+    struct sensor_value temp_in;
+    struct sensor_value humidity_in;
+    bool valid;
+
+    q16_t temp_c;
+    q16_t temp_f;
+    q16_t humidity;      // relative humidity in %
+    q16_t heat_index_c;
+    q16_t heat_index_f;
+    q16_t dew_point_c;
+};
+
+// Recompute everything from a new sample. Returns false and leaves c
+// untouched when the sample equals the one c was last computed from.
+bool comfort_update(struct comfort *c, const struct sensor_value *temp,
+                    const struct sensor_value *humidity);
+
+// Convert a sensor_value to Q16
+q16_t q16_from_sensor_value(const struct sensor_value *v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMFORT_H
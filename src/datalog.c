@@ -0,0 +1,178 @@
+#include "datalog.h"
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+LOG_MODULE_REGISTER(datalog);
+
+#define DATALOG_PARTITION FIXED_PARTITION_ID(storage_partition)
+#define DATALOG_MAGIC     0x474f4c54  // "TLOG" in flash byte order
+#define DATALOG_MAX_SECTORS 16
+
+static struct fcb fcb;
+static struct flash_sector sectors[DATALOG_MAX_SECTORS];
+static bool ready;
+static uint16_t boot;
+
+static uint8_t block_buf[CONFIG_APP_DATALOG_BLOCK_SIZE];
+static struct log_block block;
+static uint32_t block_start_s;
+
+// Shared by init and replay, both run before or on the sample loop
+static uint8_t read_buf[CONFIG_APP_DATALOG_BLOCK_SIZE];
+
+static struct datalog_stats stats;
+
+struct replay {
+    log_sample_cb cb;
+    void *arg;
+    int samples;
+};
+
+static int replay_entry(struct fcb_entry_ctx *ctx, void *arg) {
+    struct replay *r = arg;
+    uint16_t len = ctx->loc.fe_data_len;
+
+    if (len > sizeof(read_buf) ||
+        flash_area_read(ctx->fap, FCB_ENTRY_FA_DATA_OFF(ctx->loc), read_buf, len) != 0) {
+        return 0;
+    }
+    int n = log_block_decode(read_buf, len, r->cb, r->arg);
+    if (n < 0) {
+        LOG_WRN("Skipping damaged block at %x", (unsigned)FCB_ENTRY_FA_DATA_OFF(ctx->loc));
+        return 0;
+    }
+    r->samples += n;
+    return 0;
+}
+
+int datalog_replay(log_sample_cb cb, void *arg) {
+    struct replay r = { cb, arg, 0 };
+
+    if (!ready) {
+        return -ENODEV;
+    }
+    int err = fcb_walk(&fcb, NULL, replay_entry, &r);
+    return err ? err : r.samples;
+}
+
+static void find_boot(uint16_t b, uint32_t time_s, const int16_t value[HISTORY_CHANNELS], void *arg) {
+    uint16_t *last = arg;
+    *last = b;
+}
+
+int datalog_init(void) {
+    // Mounting again (after a partition swap, or from the tests) starts
+    // from scratch
+    ready = false;
+
+    uint32_t count = ARRAY_SIZE(sectors);
+    int err = flash_area_get_sectors(DATALOG_PARTITION, &count, sectors);
+
+    if (err) {
+        LOG_ERR("No sectors for the log (%d)", err);
+        return err;
+    }
+
+    fcb.f_magic = DATALOG_MAGIC;
+    fcb.f_version = LOG_BLOCK_VERSION;
+    fcb.f_sectors = sectors;
+    fcb.f_sector_cnt = count;
+    fcb.f_scratch_cnt = 0;
+    err = fcb_init(DATALOG_PARTITION, &fcb);
+    if (err && err != -ENOMSG) {
+        // A read error or similar; keep what is there for the next boot
+        LOG_ERR("Cannot mount the log (%d)", err);
+        return err;
+    }
+    if (err) {
+        // A sector header with some other magic: not our log, start over
+        LOG_WRN("Erasing log partition (%d)", err);
+        const struct flash_area *fa;
+        if (flash_area_open(DATALOG_PARTITION, &fa) == 0) {
+            flash_area_erase(fa, 0, fa->fa_size);
+            flash_area_close(fa);
+        }
+        err = fcb_init(DATALOG_PARTITION, &fcb);
+        if (err) {
+            return err;
+        }
+    }
+    ready = true;
+
+    uint16_t last_boot = 0;
+    int samples = datalog_replay(find_boot, &last_boot);
+    boot = samples > 0 ? last_boot + 1 : 0;
+    LOG_INF("%d samples logged, this is boot %u", samples, boot);
+
+    log_block_start(&block, block_buf, sizeof(block_buf), boot);
+    return 0;
+}
+
+int datalog_flush(void) {
+    struct fcb_entry loc;
+    size_t len;
+    int err;
+
+    if (!ready || block.count == 0) {
+        return 0;
+    }
+
+    len = log_block_finish(&block);
+    err = fcb_append(&fcb, len, &loc);
+    if (err == -ENOSPC) {
+        // Drop the oldest sector to make room
+        err = fcb_rotate(&fcb);
+        if (!err) {
+            stats.sectors_erased++;
+            err = fcb_append(&fcb, len, &loc);
+        }
+    }
+    if (!err) {
+        err = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), block_buf, len);
+    }
+    if (!err) {
+        err = fcb_append_finish(&fcb, &loc);
+    }
+
+    if (err) {
+        LOG_ERR("Writing a block of %u samples failed (%d)", block.count, err);
+    } else {
+        stats.blocks++;
+        stats.samples += block.count;
+        stats.payload_bytes += len;
+        // The active position moved past the entry header, data and CRC
+        stats.flash_bytes += fcb.f_active.fe_elem_off - loc.fe_elem_off;
+        LOG_INF("Logged %u samples in %u bytes, %u.%02u bytes/sample overall, "
+                "write amplification %u.%02u",
+                block.count, (unsigned)len,
+                stats.flash_bytes / stats.samples, stats.flash_bytes * 100 / stats.samples % 100,
+                stats.flash_bytes / stats.payload_bytes,
+                stats.flash_bytes * 100 / stats.payload_bytes % 100);
+    }
+
+    log_block_start(&block, block_buf, sizeof(block_buf), boot);
+    return err;
+}
+
+void datalog_add(uint32_t time_s, const int16_t value[HISTORY_CHANNELS]) {
+    if (!ready) {
+        return;
+    }
+    if (block.count == 0) {
+        block_start_s = time_s;
+    }
+    if (log_block_add(&block, time_s, value) == -ENOSPC) {
+        datalog_flush();
+        block_start_s = time_s;
+        log_block_add(&block, time_s, value);
+    }
+    if (time_s - block_start_s >= CONFIG_APP_DATALOG_BLOCK_S) {
+        datalog_flush();
+    }
+}
+
+void datalog_get_stats(struct datalog_stats *out) {
+    *out = stats;
+}
@@ -0,0 +1,35 @@
+#ifndef DATALOG_H
+#define DATALOG_H
+
+#include <stdint.h>
+#include "log_block.h"
+
+// Readings kept in flash across power cycles. Samples are collected in a
+// RAM block and written as one flash circular buffer (FCB) entry every
+// APP_DATALOG_BLOCK_S seconds or when the block is full; once the
+// partition is full the oldest sector is dropped.
+
+struct datalog_stats {
+    uint32_t blocks;
+    uint32_t samples;
+    uint32_t payload_bytes;  // encoded blocks
+    uint32_t flash_bytes;    // including the FCB entry headers and padding
+    uint32_t sectors_erased;
+};
+
+// Mount the log on storage_partition and pick this boot's number
+int datalog_init(void);
+
+// Queue a sample, flushing the block to flash when it is due
+void datalog_add(uint32_t time_s, const int16_t value[HISTORY_CHANNELS]);
+
+// Write the pending block now
+int datalog_flush(void);
+
+// Stream every stored sample, oldest first. Damaged blocks are skipped.
+// Returns the number of samples replayed.
+int datalog_replay(log_sample_cb cb, void *arg);
+
+void datalog_get_stats(struct datalog_stats *stats);
+
+#endif // DATALOG_H
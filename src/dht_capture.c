@@ -0,0 +1,112 @@
+#include "dht_capture.h"
+#include "dht_decode.h"
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/timing/timing.h>
+
+LOG_MODULE_REGISTER(dht_capture);
+
+// The host has to hold the line low for at least 18 ms to start a transfer
+#define START_LOW_MS 20
+// A whole frame takes at most about 5 ms
+#define FRAME_TIMEOUT_MS 10
+
+static K_SEM_DEFINE(frame_done, 0, 1);
+
+// Written by the interrupt while a capture is armed; only one sensor is
+// armed at a time
+static timing_t edges[DHT_FRAME_EDGES];
+static volatile int edge_count;
+
+// The line is active low, so "to active" is the falling edge
+static void edge_isr(const struct device *port, struct gpio_callback *cb, uint32_t pins) {
+    int n = edge_count;
+
+    if (n < DHT_FRAME_EDGES) {
+        edges[n] = timing_counter_get();
+        edge_count = n + 1;
+        if (n + 1 == DHT_FRAME_EDGES) {
+            k_sem_give(&frame_done);
+        }
+    }
+}
+
+static int capture(const struct gpio_dt_spec *dio, uint8_t frame[DHT_FRAME_BYTES]) {
+    uint32_t falls_us[DHT_FRAME_EDGES];
+    int err;
+
+    gpio_pin_configure_dt(dio, GPIO_OUTPUT_ACTIVE);
+    k_msleep(START_LOW_MS);
+
+    edge_count = 0;
+    k_sem_reset(&frame_done);
+    gpio_pin_configure_dt(dio, GPIO_INPUT);
+    err = gpio_pin_interrupt_configure_dt(dio, GPIO_INT_EDGE_TO_ACTIVE);
+    if (err) {
+        return err;
+    }
+
+    // A short frame times out and is judged on the edges that did arrive
+    k_sem_take(&frame_done, K_MSEC(FRAME_TIMEOUT_MS));
+    gpio_pin_interrupt_configure_dt(dio, GPIO_INT_DISABLE);
+
+    int count = edge_count;
+    for (int i = 0; i < count; i++) {
+        uint64_t cycles = timing_cycles_get(&edges[0], &edges[i]);
+        falls_us[i] = (uint32_t)(timing_cycles_to_ns(cycles) / 1000);
+    }
+    return dht_decode(falls_us, count, frame);
+}
+
+int dht_capture_init(struct dht_capture *dht) {
+    if (!gpio_is_ready_dt(&dht->dio)) {
+        return -ENODEV;
+    }
+
+    int err = gpio_pin_configure_dt(&dht->dio, GPIO_INPUT);
+    if (err) {
+        return err;
+    }
+    gpio_init_callback(&dht->edge_cb, edge_isr, BIT(dht->dio.pin));
+    err = gpio_add_callback_dt(&dht->dio, &dht->edge_cb);
+    if (err) {
+        return err;
+    }
+
+    // Starting the timing API again for a second sensor is harmless
+    timing_init();
+    timing_start();
+    return 0;
+}
+
+int dht_capture_fetch(struct dht_capture *dht, struct sensor_value *temp,
+                      struct sensor_value *humidity) {
+    uint8_t frame[DHT_FRAME_BYTES];
+    int err;
+
+    for (int attempt = 0;; attempt++) {
+        err = capture(&dht->dio, frame);
+        if (err == 0 || attempt == CONFIG_APP_DHT_RETRIES) {
+            break;
+        }
+        LOG_DBG("Bad frame (%d), retry %d", err, attempt + 1);
+        k_msleep(CONFIG_APP_DHT_RETRY_BACKOFF_MS << attempt);
+    }
+    if (err) {
+        return err;
+    }
+
+    int humidity_dd, temp_dd;
+    if (dht->dht22) {
+        dht22_values(frame, &humidity_dd, &temp_dd);
+    } else {
+        dht11_values(frame, &humidity_dd, &temp_dd);
+    }
+    temp->val1 = temp_dd / 10;
+    temp->val2 = temp_dd % 10 * 100000;
+    humidity->val1 = humidity_dd / 10;
+    humidity->val2 = humidity_dd % 10 * 100000;
+    return 0;
+}
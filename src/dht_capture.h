@@ -0,0 +1,34 @@
+#ifndef DHT_CAPTURE_H
+#define DHT_CAPTURE_H
+
+#include <stdbool.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/sensor.h>
+
+// DHT11/DHT22 reader that timestamps the edges of the data line from a
+// GPIO interrupt and decodes the frame afterwards. Unlike the Zephyr
+// driver it never locks interrupts, so SPI and the console keep running
+// while a sample comes in.
+
+// One sensor, from an "aosong,dht" devicetree node
+struct dht_capture {
+    struct gpio_dt_spec dio;
+    bool dht22;
+    struct gpio_callback edge_cb;
+};
+
+#define DHT_CAPTURE_DT_INIT(node) { \
+    .dio = GPIO_DT_SPEC_GET(node, dio_gpios), \
+    .dht22 = DT_PROP(node, dht22), \
+}
+
+// Set up the data pin
+int dht_capture_init(struct dht_capture *dht);
+
+// Read one sample, retrying with a growing delay when the frame is
+// damaged. Blocks for about 25 ms per attempt. Sensors are read one at a
+// time: call this from one thread only.
+int dht_capture_fetch(struct dht_capture *dht, struct sensor_value *temp,
+                      struct sensor_value *humidity);
+
+#endif // DHT_CAPTURE_H
@@ -0,0 +1,51 @@
+#include "dht_decode.h"
+#include <errno.h>
+#include <string.h>
+
+// Every bit starts with a 50 us low pulse followed by 26-28 us high for
+// a 0 or 70 us high for a 1, so edge to edge a bit takes about 77 or
+// 120 us. The limits leave room for interrupt latency.
+#define BIT_MIN_US       60
+#define BIT_ONE_US       100
+#define BIT_MAX_US       160
+
+int dht_decode(const uint32_t *falls_us, int count, uint8_t frame[DHT_FRAME_BYTES]) {
+    if (count < DHT_FRAME_BITS + 1) {
+        return -ENODATA;
+    }
+
+    const uint32_t *edge = falls_us + count - (DHT_FRAME_BITS + 1);
+
+    memset(frame, 0, DHT_FRAME_BYTES);
+    for (int bit = 0; bit < DHT_FRAME_BITS; bit++) {
+        uint32_t period = edge[bit + 1] - edge[bit];
+
+        if (period < BIT_MIN_US || period > BIT_MAX_US) {
+            return -EIO;
+        }
+        if (period >= BIT_ONE_US) {
+            frame[bit / 8] |= 0x80 >> (bit % 8);
+        }
+    }
+
+    uint8_t sum = frame[0] + frame[1] + frame[2] + frame[3];
+    return sum == frame[4] ? 0 : -EBADMSG;
+}
+
+void dht11_values(const uint8_t frame[DHT_FRAME_BYTES], int *humidity_dd, int *temp_dd) {
+    *humidity_dd = frame[0] * 10 + frame[1] % 10;
+
+    // Newer DHT11 parts report tenths and flag negative values in bit 7
+    *temp_dd = frame[2] * 10 + (frame[3] & 0x7f) % 10;
+    if (frame[3] & 0x80) {
+        *temp_dd = -*temp_dd;
+    }
+}
+
+void dht22_values(const uint8_t frame[DHT_FRAME_BYTES], int *humidity_dd, int *temp_dd) {
+    *humidity_dd = frame[0] << 8 | frame[1];
+    *temp_dd = (frame[2] & 0x7f) << 8 | frame[3];
+    if (frame[2] & 0x80) {
+        *temp_dd = -*temp_dd;
+    }
+}
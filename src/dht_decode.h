@@ -0,0 +1,35 @@
+#ifndef DHT_DECODE_H
+#define DHT_DECODE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DHT_FRAME_BYTES 5
+#define DHT_FRAME_BITS  (DHT_FRAME_BYTES * 8)
+
+// Falling edges in one transfer: the response, one per bit and the
+// final low pulse after the last bit
+#define DHT_FRAME_EDGES (DHT_FRAME_BITS + 2)
+
+// Decode a frame from the times (in microseconds) of the falling edges
+// on the data line. The bits are taken from the last DHT_FRAME_BITS + 1
+// edges, so a missed response edge does not matter.
+// Returns 0, -ENODATA when edges are missing, -EIO when a bit period is
+// out of range or -EBADMSG on a checksum mismatch.
+int dht_decode(const uint32_t *falls_us, int count, uint8_t frame[DHT_FRAME_BYTES]);
+
+// DHT11 frame contents: humidity in 0.1 %, temperature in 0.1 °C
+void dht11_values(const uint8_t frame[DHT_FRAME_BYTES], int *humidity_dd, int *temp_dd);
+
+// DHT22 (AM2302) frame contents, same units: 16 bit values, the
+// temperature in sign and magnitude
+void dht22_values(const uint8_t frame[DHT_FRAME_BYTES], int *humidity_dd, int *temp_dd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DHT_DECODE_H
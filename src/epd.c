@@ -0,0 +1,282 @@
+#include "epd.h"
+#include "prof.h"
+#include "tuning.h"
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+
+LOG_MODULE_REGISTER(epd);
+
+#define EPD_STACK_SIZE 1024
+#define EPD_PRIORITY   6
+
+// A frame waiting for the panel
+struct epd_job {
+    int buffer;
+    bool full;
+    int count;
+    struct fb_rect rects[FB_MAX_DIRTY];
+};
+
+static const struct device *display;
+static struct framebuffer buffers[2];
+static struct k_sem buffer_free[2];
+static uint8_t window_buf[DISPLAY_BUF_SIZE];
+
+// Renderer side state, only touched from the thread drawing frames
+static int next_buffer;
+static struct framebuffer *last_submitted;
+static int partial_updates = CONFIG_APP_FULL_REFRESH_INTERVAL;
+
+// Index of last_submitted for other threads, -1 before the first frame
+static atomic_t shown_buffer = ATOMIC_INIT(-1);
+
+// Set by the transfer thread when a write fails, or on request
+static atomic_t resync;
+
+// Time spent on transfers and refreshes, for the power budget
+static atomic_t busy_ms;
+
+static struct epd_stats stats;
+static struct k_spinlock stats_lock;
+
+K_MSGQ_DEFINE(epd_jobs, sizeof(struct epd_job), ARRAY_SIZE(buffers), 4);
+K_THREAD_STACK_DEFINE(epd_stack, EPD_STACK_SIZE);
+static struct k_thread epd_thread_data;
+
+static int full_refresh(const struct framebuffer *fb) {
+    struct display_buffer_descriptor desc = {
+        .width = PANEL_WIDTH,
+        .height = PANEL_HEIGHT,
+        .pitch = PANEL_WIDTH,
+        .buf_size = DISPLAY_BUF_SIZE,
+    };
+    const uint8_t *data = fb->data;
+
+    // Upright frames go out as they are, others are turned first
+    if (DISPLAY_ROTATION != 0) {
+        struct fb_rect all = { 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT };
+        struct fb_rect panel;
+
+        PROF_BEGIN(t_pack);
+        fb_pack_window(fb->data, &all, DISPLAY_ROTATION, window_buf, &panel);
+        PROF_END(PROF_PACK, t_pack);
+        data = window_buf;
+    }
+
+    // While blanked the ssd16xx driver only loads RAM (and switches to
+    // the full waveform); unblanking runs a single full update
+    PROF_BEGIN(t_write);
+    int err = display_blanking_on(display);
+    if (err == 0) {
+        err = display_write(display, 0, 0, &desc, data);
+    }
+    if (err == 0) {
+        err = display_blanking_off(display);
+    }
+    PROF_END(PROF_WRITE, t_write);
+    return err;
+}
+
+static int partial_refresh(const struct framebuffer *fb, const struct epd_job *job) {
+    // With the panel unblanked and a partial profile in the devicetree,
+    // every write is refreshed with the partial waveform
+    for (int i = 0; i < job->count; i++) {
+        // Where the window goes on the panel, turned if need be
+        struct fb_rect r;
+
+        PROF_BEGIN(t_pack);
+        fb_pack_window(fb->data, &job->rects[i], DISPLAY_ROTATION, window_buf, &r);
+        PROF_END(PROF_PACK, t_pack);
+
+        struct display_buffer_descriptor desc = {
+            .width = r.w,
+            .height = r.h,
+            .pitch = r.w,
+            .buf_size = r.w * r.h / 8,
+        };
+
+        PROF_BEGIN(t_write);
+        int err = display_write(display, r.x, r.y, &desc, window_buf);
+        PROF_END(PROF_WRITE, t_write);
+        if (err) {
+            LOG_ERR("Partial update of %dx%d@%d,%d failed (%d)", r.w, r.h, r.x, r.y, err);
+            return err;
+        }
+    }
+    return 0;
+}
+
+static void record_job(const struct epd_job *job, uint32_t elapsed) {
+    uint32_t bytes = 0;
+
+    if (job->full) {
+        bytes = DISPLAY_BUF_SIZE;
+    } else {
+        for (int i = 0; i < job->count; i++) {
+            bytes += job->rects[i].w * job->rects[i].h / 8;
+        }
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    if (job->full) {
+        stats.full_frames++;
+    } else {
+        stats.partial_frames++;
+    }
+    stats.bytes += bytes;
+    stats.write_ms += elapsed;
+    if (elapsed > stats.max_write_ms) {
+        stats.max_write_ms = elapsed;
+    }
+    k_spin_unlock(&stats_lock, key);
+}
+
+static void epd_thread(void *p1, void *p2, void *p3) {
+    struct epd_job job;
+
+    while (1) {
+        k_msgq_get(&epd_jobs, &job, K_FOREVER);
+
+        const struct framebuffer *fb = &buffers[job.buffer];
+        int64_t start = k_uptime_get();
+
+        int err = job.full ? full_refresh(fb) : partial_refresh(fb, &job);
+        if (err) {
+            // Get back to a known state with a full refresh next time
+            atomic_set(&resync, 1);
+        }
+
+        uint32_t elapsed = (uint32_t)(k_uptime_get() - start);
+        atomic_add(&busy_ms, elapsed);
+        record_job(&job, elapsed);
+        k_sem_give(&buffer_free[job.buffer]);
+    }
+}
+
+void epd_init(const struct device *display_dev) {
+    display = display_dev;
+    for (int i = 0; i < ARRAY_SIZE(buffers); i++) {
+        k_sem_init(&buffer_free[i], 1, 1);
+    }
+    fb_bind(&buffers[0]);
+    fb_clear();
+
+    k_thread_create(&epd_thread_data, epd_stack, K_THREAD_STACK_SIZEOF(epd_stack),
+                    epd_thread, NULL, NULL, NULL, EPD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&epd_thread_data, "epd");
+}
+
+bool epd_full_refresh_due(void) {
+    return partial_updates >= tuning_full_refresh_interval() || atomic_get(&resync);
+}
+
+void epd_request_full_refresh(void) {
+    atomic_set(&resync, 1);
+}
+
+struct framebuffer *epd_acquire(void) {
+    struct framebuffer *fb = &buffers[next_buffer];
+
+    k_sem_take(&buffer_free[next_buffer], K_FOREVER);
+
+    // The other buffer may still be on its way to the panel, reading it
+    // at the same time is fine
+    if (last_submitted && last_submitted != fb) {
+        PROF_BEGIN(t_pack);
+        memcpy(fb->data, last_submitted->data, sizeof(fb->data));
+        PROF_END(PROF_PACK, t_pack);
+    }
+    fb->dirty_count = 0;
+    fb_bind(fb);
+    return fb;
+}
+
+void epd_submit(struct framebuffer *fb) {
+    struct epd_job job = {
+        .buffer = fb - buffers,
+        .full = epd_full_refresh_due(),
+    };
+
+    job.count = fb_take_dirty(job.rects, FB_MAX_DIRTY);
+    if (!job.full && job.count == 0) {
+        // Nothing changed, the buffer can be drawn into again right away
+        k_sem_give(&buffer_free[job.buffer]);
+        return;
+    }
+
+    if (job.full) {
+        partial_updates = 0;
+        atomic_clear(&resync);
+    } else {
+        partial_updates++;
+    }
+
+    last_submitted = fb;
+    atomic_set(&shown_buffer, job.buffer);
+    next_buffer = (job.buffer + 1) % ARRAY_SIZE(buffers);
+    k_msgq_put(&epd_jobs, &job, K_FOREVER);
+}
+
+int epd_hold_bus(k_timeout_t timeout) {
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+
+    // Both buffers are free once nothing is queued or in a transfer, and
+    // holding them keeps the renderer from submitting another frame
+    for (int i = 0; i < ARRAY_SIZE(buffers); i++) {
+        int err = k_sem_take(&buffer_free[i], sys_timepoint_timeout(end));
+        if (err) {
+            while (i-- > 0) {
+                k_sem_give(&buffer_free[i]);
+            }
+            return err;
+        }
+    }
+    return 0;
+}
+
+void epd_release_bus(void) {
+    for (int i = 0; i < ARRAY_SIZE(buffers); i++) {
+        k_sem_give(&buffer_free[i]);
+    }
+}
+
+int epd_wait_idle(k_timeout_t timeout) {
+    int err = epd_hold_bus(timeout);
+
+    if (err == 0) {
+        epd_release_bus();
+    }
+    return err;
+}
+
+const struct framebuffer *epd_hold_frame(k_timeout_t timeout) {
+    while (1) {
+        int i = (int)atomic_get(&shown_buffer);
+        if (i < 0 || k_sem_take(&buffer_free[i], timeout) != 0) {
+            return NULL;
+        }
+        // Holding the semaphore keeps the renderer out of the buffer, but
+        // it may have submitted the other one in the meantime
+        if (atomic_get(&shown_buffer) == i) {
+            return &buffers[i];
+        }
+        k_sem_give(&buffer_free[i]);
+    }
+}
+
+void epd_release_frame(const struct framebuffer *fb) {
+    k_sem_give(&buffer_free[fb - buffers]);
+}
+
+uint32_t epd_take_busy_ms(void) {
+    return (uint32_t)atomic_set(&busy_ms, 0);
+}
+
+void epd_get_stats(struct epd_stats *out) {
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+    *out = stats;
+    k_spin_unlock(&stats_lock, key);
+}
@@ -0,0 +1,62 @@
+#ifndef EPD_H
+#define EPD_H
+
+#include <stdbool.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include "framebuffer.h"
+
+// Take ownership of the panel and start the transfer thread; the first
+// frame is always sent with a full refresh
+void epd_init(const struct device *display_dev);
+
+// True when the next submitted frame will redraw the whole panel,
+// callers use it to repaint everything (and shift the layout against
+// burn-in)
+bool epd_full_refresh_due(void);
+
+// Make the next frame a full refresh, e.g. to clear ghosting now
+void epd_request_full_refresh(void);
+
+// Get a framebuffer to draw the next frame into. The panel is double
+// buffered: this only blocks while both buffers are still queued for
+// or in a transfer. The buffer is bound for drawing and already holds
+// the last submitted frame, so only the changes need to be drawn.
+struct framebuffer *epd_acquire(void);
+
+// Queue a frame from epd_acquire() for the panel and return right
+// away. The transfer thread sends either the dirty windows with the
+// partial waveform, or the whole frame with the full waveform every
+// tuning_full_refresh_interval() updates (CONFIG_APP_FULL_REFRESH_INTERVAL
+// unless changed) to clear ghosting.
+void epd_submit(struct framebuffer *fb);
+
+struct epd_stats {
+    uint32_t full_frames;
+    uint32_t partial_frames;
+    uint32_t bytes;      // sent to the controller RAM
+    uint32_t write_ms;   // in display calls, refresh waveforms included
+    uint32_t max_write_ms;
+};
+
+void epd_get_stats(struct epd_stats *stats);
+
+// Wait until every submitted frame is on the panel
+int epd_wait_idle(k_timeout_t timeout);
+
+// Wait the same way, then keep the panel's bus to the caller: until
+// epd_release_bus() the transfer thread stays idle and the renderer
+// blocks in epd_acquire(). -EAGAIN on timeout, with nothing held.
+int epd_hold_bus(k_timeout_t timeout);
+void epd_release_bus(void);
+
+// Keep the frame last submitted for the panel from changing and return
+// it, NULL before the first frame or on timeout. The renderer waits for
+// it before drawing the frame after next, so release it soon.
+const struct framebuffer *epd_hold_frame(k_timeout_t timeout);
+void epd_release_frame(const struct framebuffer *fb);
+
+// Milliseconds spent driving the panel since the last call
+uint32_t epd_take_busy_ms(void);
+
+#endif // EPD_H
@@ -0,0 +1,81 @@
+#include "epd.h"
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/shell/shell.h>
+
+// The SPI bus the panel sits on
+#define EPD_SPI_NODE DT_PHANDLE(DT_PARENT(DT_CHOSEN(zephyr_display)), spi_dev)
+
+static const uint32_t bench_hz[] = { 250000, 1000000, 4000000, 8000000 };
+static uint8_t bench_buf[DISPLAY_BUF_SIZE];
+
+static int cmd_epd_stats(const struct shell *sh, size_t argc, char **argv) {
+    struct epd_stats s;
+    uint32_t frames;
+
+    epd_get_stats(&s);
+    frames = s.full_frames + s.partial_frames;
+    shell_print(sh, "frames: %u full, %u partial", s.full_frames, s.partial_frames);
+    shell_print(sh, "sent %u bytes, %u per frame", s.bytes, frames ? s.bytes / frames : 0);
+    shell_print(sh, "display calls: %u ms total, %u ms avg, %u ms max (refresh included)",
+                s.write_ms, frames ? s.write_ms / frames : 0, s.max_write_ms);
+    return 0;
+}
+
+// Push frames over the panel's SPI bus with its chip select left
+// inactive, so the controller ignores them, and measure what the bus
+// and the CPU do at each clock
+static int cmd_epd_bench(const struct shell *sh, size_t argc, char **argv) {
+    const struct device *spi = DEVICE_DT_GET(EPD_SPI_NODE);
+    int frames = argc > 1 ? atoi(argv[1]) : 10;
+    struct spi_buf buf = { .buf = bench_buf, .len = sizeof(bench_buf) };
+    struct spi_buf_set tx = { .buffers = &buf, .count = 1 };
+
+    if (frames <= 0) {
+        shell_error(sh, "frames must be positive");
+        return -EINVAL;
+    }
+    // Keep the panel's frames off the bus for the whole run, they would
+    // skew the figures and mix with the transfers below
+    int err = epd_hold_bus(K_SECONDS(10));
+    if (err) {
+        shell_error(sh, "The panel is still busy");
+        return err;
+    }
+
+    shell_print(sh, "%9s %10s %12s %14s", "clock Hz", "ms/frame", "bytes/s", "CPU us/frame");
+    for (int i = 0; i < ARRAY_SIZE(bench_hz); i++) {
+        struct spi_config cfg = {
+            .frequency = bench_hz[i],
+            .operation = SPI_OP_MODE_MASTER | SPI_WORD_SET(8) | SPI_TRANSFER_MSB,
+        };
+        k_thread_runtime_stats_t before, after;
+        int64_t start = k_uptime_get();
+
+        k_thread_runtime_stats_all_get(&before);
+        for (int f = 0; f < frames && !err; f++) {
+            err = spi_write(spi, &cfg, &tx);
+        }
+        if (err) {
+            shell_error(sh, "spi_write at %u Hz failed (%d)", bench_hz[i], err);
+            break;
+        }
+        k_thread_runtime_stats_all_get(&after);
+
+        uint32_t ms = (uint32_t)(k_uptime_get() - start);
+        uint32_t cpu_us = (uint32_t)k_cyc_to_us_floor64(after.total_cycles - before.total_cycles);
+        shell_print(sh, "%9u %10u %12u %14u", bench_hz[i], ms / frames,
+                    ms ? (uint32_t)((uint64_t)sizeof(bench_buf) * frames * 1000 / ms) : 0,
+                    cpu_us / frames);
+    }
+    epd_release_bus();
+    return err;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(epd_cmds,
+    SHELL_CMD_ARG(bench, NULL, "SPI throughput and CPU time per frame at several clocks [frames]",
+                  cmd_epd_bench, 1, 1),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((tempdemo), epd, &epd_cmds, "Panel transfer statistics", cmd_epd_stats, 1, 0);
@@ -0,0 +1,38 @@
+#include "ess_history.h"
+#include "history.h"
+#include <zephyr/sys/byteorder.h>
+
+uint32_t ess_history_first_after(uint32_t since_s) {
+    int lo = 0, hi = history_count();
+
+    // Ages [0, lo) are newer than since_s, [hi, count) are not
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (history_get(mid)->time_s > since_s) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return history_total() - lo;
+}
+
+uint16_t ess_history_pack(uint8_t *buf, uint16_t size, uint32_t *next) {
+    int room = (size - 1) / ESS_HISTORY_RECORD_SIZE;
+    uint32_t total = history_total();
+    int n = 0;
+
+    if (total - *next > (uint32_t)history_count()) {
+        *next = total - history_count();
+    }
+    for (; n < room && *next < total; n++, (*next)++) {
+        const struct history_sample *s = history_get(total - 1 - *next);
+        uint8_t *rec = &buf[1 + n * ESS_HISTORY_RECORD_SIZE];
+        sys_put_le32(s->time_s, rec);
+        sys_put_le16(s->value[HISTORY_TEMP], rec + 4);
+        sys_put_le16(s->value[HISTORY_HUMIDITY], rec + 6);
+    }
+
+    buf[0] = n;
+    return 1 + n * ESS_HISTORY_RECORD_SIZE;
+}
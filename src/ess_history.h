@@ -0,0 +1,29 @@
+#ifndef ESS_HISTORY_H
+#define ESS_HISTORY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Notifications of the History characteristic (format in ble_ess.h),
+// built from the sample ring. Callers hold the history lock.
+
+#define ESS_HISTORY_RECORD_SIZE 8
+
+// Number of the oldest held sample newer than since_s (see
+// history_total()), where a transfer asked for since_s starts
+uint32_t ess_history_first_after(uint32_t since_s);
+
+// Fill one notification of at most size bytes with the samples from
+// *next on and move *next past them. Samples that dropped out of the
+// ring in the meantime are skipped. Returns the length; a count of 0
+// means the transfer is complete.
+uint16_t ess_history_pack(uint8_t *buf, uint16_t size, uint32_t *next);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESS_HISTORY_H
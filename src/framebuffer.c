@@ -0,0 +1,385 @@
+#include "framebuffer.h"
+#include "bitops.h"
+#include <string.h>
+
+// The app draws into the frames epd.c owns and binds one before it
+// draws anything; only the host harness uses a buffer of its own
+#ifdef __ZEPHYR__
+static struct framebuffer *fb;
+#else
+static struct framebuffer default_fb;
+static struct framebuffer *fb = &default_fb;
+#endif
+
+void fb_bind(struct framebuffer *target) {
+    fb = target;
+}
+
+void fb_clear(void) {
+    memset(fb->data, 0xFF, sizeof(fb->data));
+}
+
+const uint8_t *fb_data(void) {
+    return fb->data;
+}
+
+void set_pixel(int x, int y) {
+    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) {
+        return;
+    }
+    fb->data[x + (y / 8) * DISPLAY_WIDTH] &= ~(0x80 >> (y % 8));
+}
+
+void color_white(int x, int y) {
+    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) {
+        return;
+    }
+    fb->data[x + (y / 8) * DISPLAY_WIDTH] |= 0x80 >> (y % 8);
+}
+
+void fb_blit_columns(int x, int y, const uint16_t *cols, int w, int h) {
+    if (h <= 0 || h > 16 || y >= DISPLAY_HEIGHT || y + h <= 0) {
+        return;
+    }
+
+    int c0 = x < 0 ? -x : 0;
+    int c1 = x + w > DISPLAY_WIDTH ? DISPLAY_WIDTH - x : w;
+    if (c0 >= c1) {
+        return;
+    }
+
+    // Rows outside the screen are masked off, which leaves the pages
+    // they would land in untouched
+    uint16_t keep = 0xFFFF << (16 - h);
+    if (y < 0) {
+        keep &= 0xFFFF >> -y;
+    }
+    if (y + h > DISPLAY_HEIGHT) {
+        keep &= 0xFFFF << (16 - (DISPLAY_HEIGHT - y));
+    }
+
+    int page = y < 0 ? (y - 7) / 8 : y / 8;
+    int shift = y - page * 8;
+    int first = page < 0 ? -page : 0;
+    int last = (shift + h - 1) / 8;
+    if (page + last >= DISPLAY_PAGES) {
+        last = DISPLAY_PAGES - 1 - page;
+    }
+
+    for (int c = c0; c < c1; c++) {
+        uint32_t bits = ((uint32_t)(cols[c] & keep) << 16) >> shift;
+        for (int k = first; k <= last; k++) {
+            fb->data[(page + k) * DISPLAY_WIDTH + x + c] &= ~(uint8_t)(bits >> (24 - 8 * k));
+        }
+    }
+}
+
+void fb_blit_column_run(int x, int y, uint64_t bits, int h, int w) {
+    if (h <= 0 || h > 56 || y >= DISPLAY_HEIGHT || y + h <= 0) {
+        return;
+    }
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (x + w > DISPLAY_WIDTH) {
+        w = DISPLAY_WIDTH - x;
+    }
+    if (w <= 0) {
+        return;
+    }
+
+    uint64_t keep = UINT64_MAX << (64 - h);
+    if (y < 0) {
+        keep &= UINT64_MAX >> -y;
+    }
+    if (y + h > DISPLAY_HEIGHT) {
+        keep &= UINT64_MAX << (64 - (DISPLAY_HEIGHT - y));
+    }
+
+    int page = y < 0 ? (y - 7) / 8 : y / 8;
+    int shift = y - page * 8;
+    int first = page < 0 ? -page : 0;
+    int last = (shift + h - 1) / 8;
+    if (page + last >= DISPLAY_PAGES) {
+        last = DISPLAY_PAGES - 1 - page;
+    }
+
+    bits = (bits & keep) >> shift;
+    for (int k = first; k <= last; k++) {
+        uint8_t mask = ~(uint8_t)(bits >> (56 - 8 * k));
+        uint8_t *dst = &fb->data[(page + k) * DISPLAY_WIDTH + x];
+        for (int c = 0; c < w; c++) {
+            dst[c] &= mask;
+        }
+    }
+}
+
+// Work out where a run of n byte columns at (x, y) lands: the skipped
+// leading columns, the visible count, the first page and the bit shift.
+// Returns 0 when nothing is visible.
+static int clip_bytes(int *x, int y, int *n, int *skip, int *page, int *shift) {
+    if (y <= -8 || y >= DISPLAY_HEIGHT) {
+        return 0;
+    }
+    *skip = *x < 0 ? -*x : 0;
+    if (*x + *n > DISPLAY_WIDTH) {
+        *n = DISPLAY_WIDTH - *x;
+    }
+    *n -= *skip;
+    *x += *skip;
+    *page = y < 0 ? -1 : y / 8;
+    *shift = y - *page * 8;
+    return *n > 0;
+}
+
+void fb_blit_bytes(int x, int y, const uint8_t *bytes, int n) {
+    int skip, page, shift;
+    if (!clip_bytes(&x, y, &n, &skip, &page, &shift)) {
+        return;
+    }
+    bytes += skip;
+
+    if (page >= 0) {
+        uint8_t *dst = &fb->data[page * DISPLAY_WIDTH + x];
+        for (int i = 0; i < n; i++) {
+            dst[i] &= ~(uint8_t)(bytes[i] >> shift);
+        }
+    }
+    if (shift && page + 1 < DISPLAY_PAGES) {
+        uint8_t *dst = &fb->data[(page + 1) * DISPLAY_WIDTH + x];
+        for (int i = 0; i < n; i++) {
+            dst[i] &= ~(uint8_t)(bytes[i] << (8 - shift));
+        }
+    }
+}
+
+static void ink_span(uint8_t *dst, uint8_t mask, int n) {
+    if (mask == 0xFF) {
+        memset(dst, 0x00, n);
+    } else if (mask) {
+        for (int i = 0; i < n; i++) {
+            dst[i] &= ~mask;
+        }
+    }
+}
+
+void fb_blit_repeat(int x, int y, uint8_t value, int n) {
+    int skip, page, shift;
+    if (!value || !clip_bytes(&x, y, &n, &skip, &page, &shift)) {
+        return;
+    }
+
+    if (page >= 0) {
+        ink_span(&fb->data[page * DISPLAY_WIDTH + x], value >> shift, n);
+    }
+    if (shift && page + 1 < DISPLAY_PAGES) {
+        ink_span(&fb->data[(page + 1) * DISPLAY_WIDTH + x], (uint8_t)(value << (8 - shift)), n);
+    }
+}
+
+// Clip a rectangle to the screen, returns 0 when nothing is left
+static int clip_rect(int *x, int *y, int *w, int *h) {
+    if (*x < 0) { *w += *x; *x = 0; }
+    if (*y < 0) { *h += *y; *y = 0; }
+    if (*x + *w > DISPLAY_WIDTH) *w = DISPLAY_WIDTH - *x;
+    if (*y + *h > DISPLAY_HEIGHT) *h = DISPLAY_HEIGHT - *y;
+    return *w > 0 && *h > 0;
+}
+
+void fb_clear_rect(int x, int y, int w, int h) {
+    if (!clip_rect(&x, &y, &w, &h)) {
+        return;
+    }
+
+    int y_end = y + h;
+    for (int page = y / 8; page * 8 < y_end; page++) {
+        int top = page * 8;
+        uint8_t mask = 0xFF;
+        if (y > top) mask &= 0xFF >> (y - top);
+        if (y_end < top + 8) mask &= 0xFF << (top + 8 - y_end);
+
+        uint8_t *p = &fb->data[page * DISPLAY_WIDTH + x];
+        for (int i = 0; i < w; i++) {
+            p[i] |= mask;
+        }
+    }
+}
+
+void fb_vspan(int x, int y0, int y1) {
+    if (x < 0 || x >= DISPLAY_WIDTH) {
+        return;
+    }
+    if (y0 > y1) {
+        int t = y0; y0 = y1; y1 = t;
+    }
+    if (y0 < 0) y0 = 0;
+    if (y1 >= DISPLAY_HEIGHT) y1 = DISPLAY_HEIGHT - 1;
+
+    for (int page = y0 / 8; page <= y1 / 8; page++) {
+        int top = page * 8;
+        uint8_t mask = 0xFF;
+        if (y0 > top) mask &= 0xFF >> (y0 - top);
+        if (y1 < top + 7) mask &= 0xFF << (top + 7 - y1);
+        fb->data[page * DISPLAY_WIDTH + x] &= ~mask;
+    }
+}
+
+void fb_scroll_left(int x, int y, int w, int h, int n) {
+    if (!clip_rect(&x, &y, &w, &h)) {
+        return;
+    }
+    if (n > w) {
+        n = w;
+    }
+
+    for (int page = y / 8; page < (y + h + 7) / 8; page++) {
+        uint8_t *row = &fb->data[page * DISPLAY_WIDTH + x];
+        memmove(row, row + n, w - n);
+        memset(row + w - n, 0xFF, n);
+    }
+}
+
+static int rect_area(const struct fb_rect *r) {
+    return r->w * r->h;
+}
+
+static struct fb_rect rect_union(const struct fb_rect *a, const struct fb_rect *b) {
+    int x0 = a->x < b->x ? a->x : b->x;
+    int y0 = a->y < b->y ? a->y : b->y;
+    int x1 = a->x + a->w > b->x + b->w ? a->x + a->w : b->x + b->w;
+    int y1 = a->y + a->h > b->y + b->h ? a->y + a->h : b->y + b->h;
+    struct fb_rect u = { x0, y0, x1 - x0, y1 - y0 };
+    return u;
+}
+
+static int rect_overlaps(const struct fb_rect *a, const struct fb_rect *b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w &&
+           a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+void fb_mark_dirty(int x, int y, int w, int h) {
+    if (!clip_rect(&x, &y, &w, &h)) {
+        return;
+    }
+
+    // The controller addresses RAM in whole pages, so widen to 8 rows.
+    // Sideways the frame's columns become the panel's rows, so widen
+    // those to 8 as well.
+    int y0 = y & ~7;
+    int y1 = (y + h + 7) & ~7;
+    struct fb_rect r = { x, y0, w, y1 - y0 };
+    if (DISPLAY_ROTATION % 180) {
+        r.x = x & ~7;
+        r.w = ((x + w + 7) & ~7) - r.x;
+    }
+
+    // Fold in every window the new one touches; merging can make it
+    // overlap windows it missed before, so rescan after each merge
+    for (int i = 0; i < fb->dirty_count; i++) {
+        if (rect_overlaps(&r, &fb->dirty[i])) {
+            r = rect_union(&r, &fb->dirty[i]);
+            fb->dirty[i] = fb->dirty[--fb->dirty_count];
+            i = -1;
+        }
+    }
+
+    if (fb->dirty_count < FB_MAX_DIRTY) {
+        fb->dirty[fb->dirty_count++] = r;
+        return;
+    }
+
+    // List is full: merge into the window that grows the least
+    int best = 0;
+    int best_growth = 0;
+    for (int i = 0; i < fb->dirty_count; i++) {
+        struct fb_rect u = rect_union(&r, &fb->dirty[i]);
+        int growth = rect_area(&u) - rect_area(&fb->dirty[i]);
+        if (i == 0 || growth < best_growth) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    fb->dirty[best] = rect_union(&r, &fb->dirty[best]);
+}
+
+int fb_take_dirty(struct fb_rect *rects, int max) {
+    int n = fb->dirty_count < max ? fb->dirty_count : max;
+    memcpy(rects, fb->dirty, n * sizeof(rects[0]));
+    fb->dirty_count = 0;
+    return n;
+}
+
+void fb_copy_window(const uint8_t *frame, const struct fb_rect *r, uint8_t *dst) {
+    for (int page = r->y / 8; page < (r->y + r->h) / 8; page++) {
+        memcpy(dst, &frame[page * DISPLAY_WIDTH + r->x], r->w);
+        dst += r->w;
+    }
+}
+
+// The frame's (x, y) lands on the panel at:
+//     0: (x, y)
+//    90: (PANEL_WIDTH - 1 - y, x)
+//   180: (PANEL_WIDTH - 1 - x, PANEL_HEIGHT - 1 - y)
+//   270: (y, PANEL_HEIGHT - 1 - x)
+void fb_pack_window(const uint8_t *frame, const struct fb_rect *r, int rotation, uint8_t *dst,
+                    struct fb_rect *panel) {
+    int pitch = rotation % 180 ? PANEL_HEIGHT : PANEL_WIDTH;
+
+    if (rotation == 0) {
+        *panel = *r;
+        fb_copy_window(frame, r, dst);
+        return;
+    }
+
+    if (rotation == 180) {
+        *panel = (struct fb_rect){ PANEL_WIDTH - r->x - r->w, PANEL_HEIGHT - r->y - r->h, r->w, r->h };
+        for (int page = (r->y + r->h) / 8 - 1; page >= r->y / 8; page--) {
+            const uint8_t *src = &frame[page * pitch + r->x + r->w - 1];
+            for (int i = 0; i < r->w; i++) {
+                *dst++ = bit_reverse8(*src--);
+            }
+        }
+        return;
+    }
+
+    // Sideways: the 8x8 block of frame columns x..x+7 in page p is one
+    // panel page (x / 8 from the top at 90, from the bottom at 270) across
+    // 8 panel columns, and transposing it gives exactly those 8 bytes
+    if (rotation == 90) {
+        *panel = (struct fb_rect){ PANEL_WIDTH - r->y - r->h, r->x, r->h, r->w };
+    } else {
+        *panel = (struct fb_rect){ r->y, PANEL_HEIGHT - r->x - r->w, r->h, r->w };
+    }
+    for (int page = r->y / 8; page < (r->y + r->h) / 8; page++) {
+        for (int x = r->x; x < r->x + r->w; x += 8) {
+            uint8_t t[8];
+            transpose8x8(&frame[page * pitch + x], t);
+
+            if (rotation == 90) {
+                // Frame row page*8 + j is panel column PANEL_WIDTH-1-page*8-j
+                uint8_t *out = &dst[(x - r->x) / 8 * panel->w + (r->y + r->h) - 1 - page * 8];
+                for (int j = 0; j < 8; j++) {
+                    *out-- = t[j];
+                }
+            } else {
+                // Frame row page*8 + j is panel column page*8 + j; the
+                // frame's left column is the bottom row of the page
+                uint8_t *out = &dst[(r->x + r->w - 8 - x) / 8 * panel->w + page * 8 - r->y];
+                for (int j = 0; j < 8; j++) {
+                    *out++ = bit_reverse8(t[j]);
+                }
+            }
+        }
+    }
+}
+
+void fb_pbm_row(const uint8_t *frame, int y, uint8_t *row) {
+    const uint8_t *page = &frame[(y / 8) * DISPLAY_WIDTH];
+    int bit = 7 - y % 8;
+
+    memset(row, 0, (DISPLAY_WIDTH + 7) / 8);
+    for (int x = 0; x < DISPLAY_WIDTH; x++) {
+        row[x / 8] |= (~page[x] >> bit & 1) << (7 - x % 8);
+    }
+}
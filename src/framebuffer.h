@@ -0,0 +1,150 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <stdint.h>
+#ifdef __ZEPHYR__
+#include <zephyr/devicetree.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The size of the chosen display node; the height is rounded down to
+// whole pages, the controller is written in them (122 -> 120). Host
+// builds default to the 2.13" panel in the board overlay.
+#ifdef __ZEPHYR__
+#define PANEL_WIDTH        DT_PROP(DT_CHOSEN(zephyr_display), width)
+#define PANEL_HEIGHT       (DT_PROP(DT_CHOSEN(zephyr_display), height) / 8 * 8)
+#define DISPLAY_ROTATION   DT_PROP_OR(DT_CHOSEN(tempdemo_layout), rotation, 0)
+#else
+#ifndef PANEL_WIDTH
+#define PANEL_WIDTH        256
+#endif
+#ifndef PANEL_HEIGHT
+#define PANEL_HEIGHT       120
+#endif
+#ifndef DISPLAY_ROTATION
+#define DISPLAY_ROTATION   0
+#endif
+#endif
+
+// Everything is drawn upright into a DISPLAY_WIDTH x DISPLAY_HEIGHT
+// frame, which is turned clockwise by DISPLAY_ROTATION degrees on its
+// way to the panel (fb_pack_window()). At 90 and 270 the frame is
+// PANEL_HEIGHT wide and PANEL_WIDTH high.
+#define DISPLAY_WIDTH      ((DISPLAY_ROTATION) % 180 ? PANEL_HEIGHT : PANEL_WIDTH)
+#define DISPLAY_HEIGHT     ((DISPLAY_ROTATION) % 180 ? PANEL_WIDTH : PANEL_HEIGHT)
+#define DISPLAY_PITCH      DISPLAY_WIDTH
+
+// The buffer is kept in the SSD1680's native layout (vertically tiled,
+// MSB first): byte x + page * DISPLAY_WIDTH holds pixels (x, page*8)
+// to (x, page*8 + 7), top pixel in bit 7. A cleared bit is a black pixel.
+#define DISPLAY_PAGES      (DISPLAY_HEIGHT / 8)
+#define DISPLAY_BUF_SIZE   (DISPLAY_WIDTH * DISPLAY_PAGES)
+
+_Static_assert(DISPLAY_ROTATION % 90 == 0 && DISPLAY_ROTATION >= 0 && DISPLAY_ROTATION < 360,
+               "rotation is 0, 90, 180 or 270");
+_Static_assert(DISPLAY_HEIGHT % 8 == 0, "turned sideways, the panel width has to be whole pages");
+
+// Maximum number of separate dirty windows kept before they get merged
+#define FB_MAX_DIRTY       4
+
+// Screen area; dirty windows always have y and h aligned to 8 rows, and
+// at 90 and 270 degrees x and w to 8 columns too (they become pages)
+struct fb_rect {
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+};
+
+// One frame plus the windows that changed since it was last sent
+struct framebuffer {
+    uint8_t data[DISPLAY_BUF_SIZE];
+    struct fb_rect dirty[FB_MAX_DIRTY];
+    int dirty_count;
+};
+
+// Direct all drawing below to fb. Nothing is bound at start on the
+// target, so a buffer has to be bound before the first drawing call;
+// host builds start with a built-in one.
+void fb_bind(struct framebuffer *fb);
+
+// Fill the whole framebuffer with white
+void fb_clear(void);
+
+// Packed data of the bound buffer, ready to be handed to display_write()
+const uint8_t *fb_data(void);
+
+// Draw a black pixel, out of range coordinates are ignored
+void set_pixel(int x, int y);
+
+// Draw a white pixel, out of range coordinates are ignored
+void color_white(int x, int y);
+
+// Draw up to 16 rows of black pixels from column words: bit 15 of
+// cols[i] is the pixel at (x + i, y), bit 14 the one below it and so on.
+// Clipping is worked out once for the whole block, each column then
+// costs one shifted word and two or three byte ANDs.
+void fb_blit_columns(int x, int y, const uint16_t *cols, int w, int h);
+
+// Draw one column word w times side by side: bit 63 of bits is the pixel
+// at (x, y), bit 62 the one below it and so on, for h <= 56 rows (the
+// column has to fit 64 bits after the shift to its page). Each page the
+// column crosses is one byte ANDed into w neighbouring framebuffer bytes.
+void fb_blit_column_run(int x, int y, uint64_t bits, int h, int w);
+
+// Draw n columns of 8 pixels in the buffer's own byte format: bit 7 of
+// bytes[i] is the pixel at (x + i, y), set bits are black. When y is a
+// multiple of 8 each byte lands in exactly one framebuffer byte.
+void fb_blit_bytes(int x, int y, const uint8_t *bytes, int n);
+
+// Same as fb_blit_bytes() with all n bytes equal to value; a run of
+// solid 0xFF on a page boundary becomes a single memset
+void fb_blit_repeat(int x, int y, uint8_t value, int n);
+
+// Fill a rectangle with white, clipped to the screen
+void fb_clear_rect(int x, int y, int w, int h);
+
+// Draw a black vertical line in column x from y0 to y1 inclusive, one
+// masked AND per page it crosses
+void fb_vspan(int x, int y0, int y1);
+
+// Move the contents of a rectangle n columns to the left, one memmove
+// per page; the columns freed on the right become white. The rectangle
+// is widened to whole pages vertically.
+void fb_scroll_left(int x, int y, int w, int h, int n);
+
+// Record that an area changed and has to be sent to the panel
+void fb_mark_dirty(int x, int y, int w, int h);
+
+// Move the dirty windows into rects (up to max) and reset the list,
+// returns the number of windows
+int fb_take_dirty(struct fb_rect *rects, int max);
+
+// Copy a page aligned window of frame (a full framebuffer's data) into
+// dst as a contiguous buffer with pitch r->w, the layout display_write()
+// expects for a sub-window
+void fb_copy_window(const uint8_t *frame, const struct fb_rect *r, uint8_t *dst);
+
+// Same for a frame drawn upright and turned clockwise by rotation
+// degrees on the panel: packs window r of frame into dst in the panel's
+// own layout and returns where it goes on the panel, with pitch
+// panel->w. Sideways, 8x8 blocks are transposed a whole block at a
+// time, which needs r aligned to 8 columns as well; upside down, pages
+// and columns are walked backwards with the bits of each byte reversed.
+// The frame's size follows from PANEL_WIDTH/HEIGHT and rotation.
+void fb_pack_window(const uint8_t *frame, const struct fb_rect *r, int rotation, uint8_t *dst,
+                    struct fb_rect *panel);
+
+// Row y of frame (a full framebuffer's data) as a PBM raster row: black
+// pixels as set bits, leftmost in bit 7 of row[0], (DISPLAY_WIDTH + 7) / 8
+// bytes with any padding bits at the end cleared
+void fb_pbm_row(const uint8_t *frame, int y, uint8_t *row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAMEBUFFER_H
@@ -0,0 +1,34 @@
+#include "fusion.h"
+
+int16_t fuse(int16_t *values, int n, int16_t max_dev) {
+    // A handful of probes at most: insertion sort
+    for (int i = 1; i < n; i++) {
+        int16_t v = values[i];
+        int j = i;
+        for (; j > 0 && values[j - 1] > v; j--) {
+            values[j] = values[j - 1];
+        }
+        values[j] = v;
+    }
+
+    int32_t median = n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+    if (max_dev <= 0) {
+        return (int16_t)median;
+    }
+
+    int32_t sum = 0;
+    int used = 0;
+    for (int i = 0; i < n; i++) {
+        int32_t dev = values[i] - median;
+        if (dev <= max_dev && dev >= -max_dev) {
+            sum += values[i];
+            used++;
+        }
+    }
+    // The middle value is always within range of an odd count's median;
+    // an even count can leave nothing when the middle pair is far apart
+    if (used == 0) {
+        return (int16_t)median;
+    }
+    return (int16_t)((sum + (sum >= 0 ? used / 2 : -(used / 2))) / used);
+}
@@ -0,0 +1,20 @@
+#ifndef FUSION_H
+#define FUSION_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Combine one channel read by several probes at the same place. The
+// values are sorted in place. The result is the mean of the values
+// within max_dev of their median, so one failing probe cannot drag the
+// reading away; with max_dev 0 it is the median itself. n must be > 0.
+int16_t fuse(int16_t *values, int n, int16_t max_dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FUSION_H
@@ -0,0 +1,137 @@
+#include "graph.h"
+#include "framebuffer.h"
+
+static int buckets_per_column(const struct graph *g) {
+    int per = HISTORY_BUCKETS / g->w;
+    return per > 0 ? per : 1;
+}
+
+// Extremes of one column; false when nothing was sampled in it
+static bool column_range(const struct graph *g, uint32_t column, int16_t *lo, int16_t *hi) {
+    int per = buckets_per_column(g);
+    bool any = false;
+
+    for (int i = 0; i < per; i++) {
+        const struct history_bucket *b = history_bucket(column * per + i);
+        if (!b || b->min[g->channel] > b->max[g->channel]) {
+            continue;
+        }
+        if (!any || b->min[g->channel] < *lo) *lo = b->min[g->channel];
+        if (!any || b->max[g->channel] > *hi) *hi = b->max[g->channel];
+        any = true;
+    }
+    return any;
+}
+
+static int row_of(const struct graph *g, int16_t v) {
+    return g->y + g->h - 1 - (int32_t)(v - g->lo) * (g->h - 1) / (g->hi - g->lo);
+}
+
+// Draw the column for one column number as a vertical span, stretched to
+// meet the previous column so the line stays connected
+static void draw_column(const struct graph *g, uint32_t column) {
+    int x = g->x + g->w - 1 - (int)(g->newest - column);
+    int16_t lo, hi, prev_lo, prev_hi;
+
+    fb_clear_rect(x, g->y, 1, g->h);
+    if (!column_range(g, column, &lo, &hi)) {
+        return;
+    }
+    if (column > 0 && x > g->x && column_range(g, column - 1, &prev_lo, &prev_hi)) {
+        if (prev_hi < lo) lo = prev_hi;
+        if (prev_lo > hi) hi = prev_lo;
+    }
+    fb_vspan(x, row_of(g, hi), row_of(g, lo));
+}
+
+// Axis range over every column on screen, rounded out to whole steps
+static void fit_axis(struct graph *g) {
+    int16_t lo = 0, hi = 0;
+    bool any = false;
+
+    for (int i = 0; i < g->w && (uint32_t)i <= g->newest; i++) {
+        int16_t c_lo, c_hi;
+        if (column_range(g, g->newest - i, &c_lo, &c_hi)) {
+            if (!any || c_lo < lo) lo = c_lo;
+            if (!any || c_hi > hi) hi = c_hi;
+            any = true;
+        }
+    }
+
+    int32_t step = g->step;
+    int32_t a = (lo >= 0 ? lo : lo - step + 1) / step * step;
+    int32_t b = (hi >= 0 ? hi + step - 1 : hi) / step * step;
+    while (b - a < g->min_span || b == a) {
+        a -= step;
+        b += step;
+    }
+    g->lo = (int16_t)a;
+    g->hi = (int16_t)b;
+}
+
+static void redraw(struct graph *g) {
+    fit_axis(g);
+    fb_clear_rect(g->x, g->y, g->w, g->h);
+    for (int i = g->w - 1; i >= 0; i--) {
+        if ((uint32_t)i <= g->newest) {
+            draw_column(g, g->newest - i);
+        }
+    }
+    fb_mark_dirty(g->x, g->y, g->w, g->h);
+    g->drawn = true;
+}
+
+void graph_update(struct graph *g, int x, int y) {
+    uint32_t bucket;
+    int16_t lo, hi;
+
+    if (history_newest_bucket(&bucket) != 0) {
+        return;
+    }
+    uint32_t newest = bucket / buckets_per_column(g);
+
+    // Scrolling works on whole pages, so a layout offset that moves the
+    // graph down by a row or two must not take it off its page
+    y &= ~7;
+
+    if (!g->drawn || g->x != x || g->y != y) {
+        if (g->drawn) {
+            fb_clear_rect(g->x, g->y, g->w, g->h);
+            fb_mark_dirty(g->x, g->y, g->w, g->h);
+        }
+        g->x = x;
+        g->y = y;
+        g->newest = newest;
+        redraw(g);
+        return;
+    }
+
+    // A value outside the axes needs a new scale and a full redraw
+    if (column_range(g, newest, &lo, &hi) && (lo < g->lo || hi > g->hi)) {
+        g->newest = newest;
+        redraw(g);
+        return;
+    }
+
+    if (newest != g->newest) {
+        uint32_t shift = newest - g->newest;
+        uint32_t first = shift < (uint32_t)g->w ? g->newest : newest - (g->w - 1);
+
+        fb_scroll_left(g->x, g->y, g->w, g->h, shift < (uint32_t)g->w ? (int)shift : g->w);
+        g->newest = newest;
+        // Starting at the old newest column, which may have gained
+        // samples since it was drawn
+        for (uint32_t column = first; column <= newest; column++) {
+            draw_column(g, column);
+        }
+        fb_mark_dirty(g->x, g->y, g->w, g->h);
+        return;
+    }
+
+    draw_column(g, newest);
+    fb_mark_dirty(g->x + g->w - 1, g->y, 1, g->h);
+}
+
+void graph_reset(struct graph *g) {
+    g->drawn = false;
+}
@@ -0,0 +1,46 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sparkline of one history channel, newest bucket in the rightmost
+// column. When there are more buckets than columns each column shows
+// the min/max of several. h has to be a multiple of 8 and the graph is
+// drawn from the page y falls in, so scrolling does not touch
+// neighbouring rows.
+struct graph {
+    uint8_t channel;     // enum history_channel
+    int16_t w;
+    int16_t h;
+    int16_t step;        // axis limits are multiples of this
+    int16_t min_span;    // smallest lo..hi range, in channel units
+
+    // Retained state
+    bool drawn;
+    int16_t x;
+    int16_t y;
+    int16_t lo;
+    int16_t hi;
+    uint32_t newest;     // newest column drawn, in column numbers
+};
+
+// Bring the graph at (x, y) up to date with the history. Normally only
+// the newest column is redrawn; a new column scrolls the plot left, and
+// the whole graph is redrawn only when a value leaves the axis range or
+// the graph moved. Changed areas are marked dirty.
+void graph_update(struct graph *g, int x, int y);
+
+// Forget what is on screen, the next update redraws everything
+void graph_reset(struct graph *g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GRAPH_H
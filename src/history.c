@@ -0,0 +1,228 @@
+#include "history.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+_Static_assert(HISTORY_DEPTH >= 2 && HISTORY_DEPTH <= UINT16_MAX, "ring slots are 16 bit");
+
+// Ring slots of the candidates for the window minimum (or maximum), in
+// arrival order with strictly increasing (decreasing) values. The front
+// is the current extreme; it expires when its slot is overwritten.
+struct deque {
+    uint16_t slot[HISTORY_DEPTH];
+    uint16_t head;
+    uint16_t len;
+};
+
+struct channel {
+    struct deque min;
+    struct deque max;
+    int64_t sum_y;
+    int64_t sum_ty;
+};
+
+static struct history_sample ring[HISTORY_DEPTH];
+static uint16_t next;   // slot the next sample goes to
+static uint16_t count;
+static uint32_t total;  // samples added since boot
+static struct channel channels[HISTORY_CHANNELS];
+
+// Coarse history for the graphs: a ring indexed by bucket number
+static struct history_bucket buckets[HISTORY_BUCKETS];
+static uint32_t newest_bucket;
+static uint32_t oldest_bucket;
+static bool have_buckets;
+
+// Sums for the trend, with times relative to the oldest sample so they
+// stay small however long the device runs
+static uint32_t base_s;
+static int64_t sum_t;
+static int64_t sum_tt;
+
+static uint16_t deque_at(const struct deque *q, int i) {
+    return q->slot[(q->head + i) % HISTORY_DEPTH];
+}
+
+static void deque_push(struct deque *q, int channel, uint16_t slot, bool keep_min) {
+    int16_t v = ring[slot].value[channel];
+
+    // Drop candidates the new sample outlives and beats
+    while (q->len > 0) {
+        int16_t back = ring[deque_at(q, q->len - 1)].value[channel];
+        if (keep_min ? back < v : back > v) {
+            break;
+        }
+        q->len--;
+    }
+    q->slot[(q->head + q->len) % HISTORY_DEPTH] = slot;
+    q->len++;
+}
+
+static void deque_expire(struct deque *q, uint16_t slot) {
+    if (q->len > 0 && q->slot[q->head] == slot) {
+        q->head = (q->head + 1) % HISTORY_DEPTH;
+        q->len--;
+    }
+}
+
+// Move the time origin to a new oldest sample
+static void rebase(uint32_t new_base) {
+    int64_t d = (int64_t)(new_base - base_s);
+
+    sum_tt += -2 * d * sum_t + d * d * count;
+    sum_t -= d * count;
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        channels[c].sum_ty -= d * channels[c].sum_y;
+    }
+    base_s = new_base;
+}
+
+static void drop_oldest(void) {
+    uint16_t slot = (next + HISTORY_DEPTH - count) % HISTORY_DEPTH;
+    const struct history_sample *s = &ring[slot];
+    int64_t t = (int64_t)(s->time_s - base_s);
+
+    sum_t -= t;
+    sum_tt -= t * t;
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        channels[c].sum_y -= s->value[c];
+        channels[c].sum_ty -= t * s->value[c];
+        deque_expire(&channels[c].min, slot);
+        deque_expire(&channels[c].max, slot);
+    }
+    count--;
+    if (count > 0) {
+        rebase(ring[(slot + 1) % HISTORY_DEPTH].time_s);
+    }
+}
+
+static void bucket_start(uint32_t seq) {
+    struct history_bucket *b = &buckets[seq % HISTORY_BUCKETS];
+
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        b->min[c] = INT16_MAX;
+        b->max[c] = INT16_MIN;
+    }
+}
+
+static void bucket_add(uint32_t time_s, const int16_t value[HISTORY_CHANNELS]) {
+    uint32_t seq = time_s / HISTORY_BUCKET_S;
+
+    if (!have_buckets) {
+        oldest_bucket = newest_bucket = seq;
+        bucket_start(seq);
+        have_buckets = true;
+    }
+
+    // Open every bucket up to this one, empty ones included; no more
+    // than the ring holds after a long gap
+    if (seq > newest_bucket) {
+        uint32_t first = seq - newest_bucket > HISTORY_BUCKETS ? seq - HISTORY_BUCKETS + 1
+                                                               : newest_bucket + 1;
+        for (uint32_t i = first; i <= seq; i++) {
+            bucket_start(i);
+        }
+        newest_bucket = seq;
+        if (newest_bucket - oldest_bucket >= HISTORY_BUCKETS) {
+            oldest_bucket = newest_bucket - HISTORY_BUCKETS + 1;
+        }
+    }
+
+    struct history_bucket *b = &buckets[newest_bucket % HISTORY_BUCKETS];
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        if (value[c] < b->min[c]) b->min[c] = value[c];
+        if (value[c] > b->max[c]) b->max[c] = value[c];
+    }
+}
+
+void history_add(uint32_t time_s, const int16_t value[HISTORY_CHANNELS]) {
+    // The oldest sample is at base_s
+    while (count > 0 && time_s - base_s >= HISTORY_WINDOW_S) {
+        drop_oldest();
+    }
+    if (count == HISTORY_DEPTH) {
+        drop_oldest();
+    }
+    if (count == 0) {
+        base_s = time_s;
+    }
+
+    uint16_t slot = next;
+    int64_t t = (int64_t)(time_s - base_s);
+
+    ring[slot].time_s = time_s;
+    sum_t += t;
+    sum_tt += t * t;
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        ring[slot].value[c] = value[c];
+        channels[c].sum_y += value[c];
+        channels[c].sum_ty += t * value[c];
+        deque_push(&channels[c].min, c, slot, true);
+        deque_push(&channels[c].max, c, slot, false);
+    }
+    next = (next + 1) % HISTORY_DEPTH;
+    count++;
+    total++;
+
+    bucket_add(time_s, value);
+}
+
+// num * mul / den, halving both sides while the product would overflow
+static int32_t scaled_ratio(int64_t num, int32_t mul, int64_t den) {
+    while (num > INT64_MAX / mul || num < -(INT64_MAX / mul)) {
+        num /= 2;
+        den /= 2;
+    }
+    return den != 0 ? (int32_t)(num * mul / den) : 0;
+}
+
+int history_stats(enum history_channel channel, struct history_stats *stats) {
+    const struct channel *ch = &channels[channel];
+
+    if (count == 0) {
+        return -ENODATA;
+    }
+
+    int64_t sum_y = ch->sum_y;
+    stats->count = count;
+    stats->span_s = history_get(0)->time_s - base_s;
+    stats->min = ring[ch->min.slot[ch->min.head]].value[channel];
+    stats->max = ring[ch->max.slot[ch->max.head]].value[channel];
+    stats->mean = (int16_t)((sum_y + (sum_y >= 0 ? count / 2 : -(count / 2))) / count);
+
+    // Slope of the least squares line through all samples
+    int64_t num = count * ch->sum_ty - sum_t * sum_y;
+    int64_t den = count * sum_tt - sum_t * sum_t;
+    stats->trend_per_hour = scaled_ratio(num, 3600, den);
+    return 0;
+}
+
+int history_count(void) {
+    return count;
+}
+
+uint32_t history_total(void) {
+    return total;
+}
+
+const struct history_sample *history_get(int age) {
+    if (age < 0 || age >= count) {
+        return NULL;
+    }
+    return &ring[(next + HISTORY_DEPTH - 1 - age) % HISTORY_DEPTH];
+}
+
+int history_newest_bucket(uint32_t *seq) {
+    if (!have_buckets) {
+        return -ENODATA;
+    }
+    *seq = newest_bucket;
+    return 0;
+}
+
+const struct history_bucket *history_bucket(uint32_t seq) {
+    if (!have_buckets || seq < oldest_bucket || seq > newest_bucket) {
+        return NULL;
+    }
+    return &buckets[seq % HISTORY_BUCKETS];
+}
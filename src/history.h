@@ -0,0 +1,76 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HISTORY_DEPTH    CONFIG_APP_HISTORY_DEPTH
+#define HISTORY_WINDOW_S CONFIG_APP_HISTORY_WINDOW_S
+#define HISTORY_BUCKETS  CONFIG_APP_HISTORY_BUCKETS
+#define HISTORY_BUCKET_S CONFIG_APP_HISTORY_BUCKET_S
+
+enum history_channel {
+    HISTORY_TEMP,      // hundredths of a degree C
+    HISTORY_HUMIDITY,  // hundredths of a percent
+    HISTORY_CHANNELS,
+};
+
+// One sample, 8 bytes
+struct history_sample {
+    uint32_t time_s;  // uptime
+    int16_t value[HISTORY_CHANNELS];
+};
+
+// Statistics over the samples currently in the ring: those of the last
+// HISTORY_WINDOW_S seconds up to the newest one, fewer if the ring filled
+struct history_stats {
+    int count;
+    uint32_t span_s;        // newest minus oldest timestamp
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    int32_t trend_per_hour; // least squares slope, same unit as the values
+};
+
+// Extremes of the samples in one HISTORY_BUCKET_S slice of uptime. A
+// bucket nobody sampled in has min > max.
+struct history_bucket {
+    int16_t min[HISTORY_CHANNELS];
+    int16_t max[HISTORY_CHANNELS];
+};
+
+// Append a sample, dropping the ones that are HISTORY_WINDOW_S or more
+// older, and the oldest one if the ring is still full. All statistics
+// are updated in amortised O(1).
+void history_add(uint32_t time_s, const int16_t value[HISTORY_CHANNELS]);
+
+// Returns -ENODATA while the ring is empty
+int history_stats(enum history_channel channel, struct history_stats *stats);
+
+// Number of samples held
+int history_count(void);
+
+// Samples added since boot. Sample n (counting from 0) is
+// history_get(history_total() - 1 - n) for as long as the ring holds it.
+uint32_t history_total(void);
+
+// Sample by age, 0 being the newest; NULL past the oldest
+const struct history_sample *history_get(int age);
+
+// Buckets are numbered by uptime / HISTORY_BUCKET_S. Returns the number
+// of the newest one, which is still filling; -ENODATA before the first
+// sample.
+int history_newest_bucket(uint32_t *seq);
+
+// Bucket by number; NULL unless it is among the last HISTORY_BUCKETS
+// and after the first sample
+const struct history_bucket *history_bucket(uint32_t seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HISTORY_H
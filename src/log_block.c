@@ -0,0 +1,144 @@
+#include "log_block.h"
+#include <errno.h>
+
+uint32_t log_crc32(const uint8_t *data, size_t len) {
+    // Reflected polynomial 0xEDB88320, a nibble at a time
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static void put_le(uint8_t *p, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint32_t get_le(const uint8_t *p, int bytes) {
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++) {
+        v |= (uint32_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+// Small magnitudes of either sign become small unsigned numbers
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static size_t put_varint(uint8_t *p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns the bytes used, 0 when the varint runs past end
+static size_t get_varint(const uint8_t *p, const uint8_t *end, uint32_t *v) {
+    *v = 0;
+    for (size_t n = 0; n < 5 && p + n < end; n++) {
+        *v |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+void log_block_start(struct log_block *b, uint8_t *buf, size_t size, uint16_t boot) {
+    b->buf = buf;
+    b->size = size;
+    b->len = LOG_BLOCK_HEADER;
+    b->count = 0;
+    b->last_time = 0;
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        b->last[c] = 0;
+    }
+    buf[0] = LOG_BLOCK_VERSION;
+    buf[1] = HISTORY_CHANNELS;
+    put_le(&buf[2], boot, 2);
+    put_le(&buf[4], 0, 4);
+}
+
+int log_block_add(struct log_block *b, uint32_t time_s, const int16_t value[HISTORY_CHANNELS]) {
+    if (b->len + LOG_BLOCK_SAMPLE_MAX + LOG_BLOCK_TRAILER > b->size || b->count == UINT16_MAX) {
+        return -ENOSPC;
+    }
+
+    if (b->count == 0) {
+        put_le(&b->buf[4], time_s, 4);
+        b->last_time = time_s;
+    }
+    b->len += put_varint(&b->buf[b->len], zigzag((int32_t)(time_s - b->last_time)));
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        b->len += put_varint(&b->buf[b->len], zigzag(value[c] - b->last[c]));
+        b->last[c] = value[c];
+    }
+    b->last_time = time_s;
+    b->count++;
+    return 0;
+}
+
+size_t log_block_finish(struct log_block *b) {
+    put_le(&b->buf[8], b->count, 2);
+    put_le(&b->buf[b->len], log_crc32(b->buf, b->len), 4);
+    return b->len + LOG_BLOCK_TRAILER;
+}
+
+int log_block_decode(const uint8_t *buf, size_t len, log_sample_cb cb, void *arg) {
+    if (len < LOG_BLOCK_HEADER + LOG_BLOCK_TRAILER || buf[0] != LOG_BLOCK_VERSION ||
+        buf[1] != HISTORY_CHANNELS) {
+        return -EBADMSG;
+    }
+    len -= LOG_BLOCK_TRAILER;
+    if (log_crc32(buf, len) != get_le(&buf[len], 4)) {
+        return -EBADMSG;
+    }
+
+    uint16_t boot = (uint16_t)get_le(&buf[2], 2);
+    uint32_t time_s = get_le(&buf[4], 4);
+    int count = (int)get_le(&buf[8], 2);
+    int16_t value[HISTORY_CHANNELS] = { 0 };
+    const uint8_t *p = buf + LOG_BLOCK_HEADER;
+    const uint8_t *end = buf + len;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t v;
+        size_t n = get_varint(p, end, &v);
+
+        if (!n) {
+            return -EBADMSG;
+        }
+        p += n;
+        time_s += (uint32_t)unzigzag(v);
+        for (int c = 0; c < HISTORY_CHANNELS; c++) {
+            n = get_varint(p, end, &v);
+            if (!n) {
+                return -EBADMSG;
+            }
+            p += n;
+            value[c] = (int16_t)(value[c] + unzigzag(v));
+        }
+        cb(boot, time_s, value, arg);
+    }
+    return p == end ? count : -EBADMSG;
+}
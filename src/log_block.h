@@ -0,0 +1,62 @@
+#ifndef LOG_BLOCK_H
+#define LOG_BLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A block of samples as stored in flash, all fields little endian:
+//
+//   u8   version
+//   u8   channels
+//   u16  boot number
+//   u32  time of the first sample, seconds of uptime
+//   u16  sample count
+//   ...  per sample a zigzag varint time delta, then one zigzag varint
+//        delta per channel; the first sample is relative to zero values
+//   u32  CRC-32 (IEEE) of everything before it
+//
+// At 1 Hz with slowly moving values a sample takes about 3 bytes.
+#define LOG_BLOCK_VERSION  1
+#define LOG_BLOCK_HEADER   10
+#define LOG_BLOCK_TRAILER  4
+// Worst case size of one sample
+#define LOG_BLOCK_SAMPLE_MAX (5 + 3 * HISTORY_CHANNELS)
+
+struct log_block {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    uint16_t count;
+    uint32_t last_time;
+    int16_t last[HISTORY_CHANNELS];
+};
+
+// Start an empty block in buf
+void log_block_start(struct log_block *b, uint8_t *buf, size_t size, uint16_t boot);
+
+// Append a sample; -ENOSPC when it does not fit any more
+int log_block_add(struct log_block *b, uint32_t time_s, const int16_t value[HISTORY_CHANNELS]);
+
+// Fill in the count and CRC, returns the length to store
+size_t log_block_finish(struct log_block *b);
+
+typedef void (*log_sample_cb)(uint16_t boot, uint32_t time_s,
+                              const int16_t value[HISTORY_CHANNELS], void *arg);
+
+// Check and decode a stored block, calling cb for every sample in order.
+// Returns the number of samples or -EBADMSG when the block is damaged.
+int log_block_decode(const uint8_t *buf, size_t len, log_sample_cb cb, void *arg);
+
+// CRC-32 as used for the trailer
+uint32_t log_crc32(const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_BLOCK_H
@@ -1,54 +1,176 @@
 #include "my_image.h"
+#include "framebuffer.h"
+#include <stdbool.h>
+#include <string.h>
 
-//pitch calculation: width/8 rounded up
-//array size: height*pitch
+// The icons themselves are generated from the files in assets/ by
+// scripts/img2c.py at build time.
 
-const uint8_t raindrop_data[77] = {
-// 'raindrop(1)', 30x30px
-// 'raindrop(1)(1)', 22x22px
-0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x78, 0x00, 0x00, 0x78, 0x00, 0x00, 0xfc, 0x00, 0x00, 
-0xfc, 0x00, 0x01, 0xfe, 0x00, 0x03, 0xff, 0x00, 0x03, 0xff, 0x00, 0x07, 0xff, 0x80, 0x07, 0xff, 
-0x80, 0x07, 0xff, 0x80, 0x0f, 0xff, 0xc0, 0x0f, 0xff, 0xc0, 0x0f, 0xff, 0xc0, 0x0f, 0xff, 0xc0, 
-0x0f, 0xff, 0xc0, 0x0f, 0xff, 0xc0, 0x07, 0xff, 0x80, 0x07, 0xff, 0x80, 0x03, 0xff, 0x00, 0x00, 
-0xfc, 0x00};
+// Decode one PackBits band straight into the framebuffer; zero runs
+// are skipped and solid runs become whole byte spans
+static const uint8_t *draw_rle_band(int x, int y, int width, const uint8_t *src) {
+    int col = 0;
 
+    while (col < width) {
+        int8_t n = (int8_t)*src++;
+        if (n >= 0) {
+            fb_blit_bytes(x + col, y, src, n + 1);
+            src += n + 1;
+            col += n + 1;
+        } else if (n != -128) {
+            fb_blit_repeat(x + col, y, *src++, 1 - n);
+            col += 1 - n;
+        }
+    }
+    return src;
+}
 
- const Img raindrop = {
-    .width = 22,
-    .height = 22,
-    .pitch = 3,  // width in bytes (250 / 8 = 31.25 → round up)
-    .img_data = raindrop_data
-};
+static void draw_rle(int x_offset, int y_offset, const Img *image) {
+    const uint8_t *src = image->img_data;
 
+    for (int band = 0; band * 8 < image->height; band++) {
+        src = draw_rle_band(x_offset, y_offset + band * 8, image->pitch, src);
+    }
+}
 
-const uint8_t flame_data[333]={
-// 'flame(2)', 55x46px
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x00, 
-0x00, 0x00, 0x00, 0x01, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xf0, 0x00, 0x00, 0x00, 0x00, 
-0x00, 0x01, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 
-0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xfe, 0x00, 
-0x00, 0x00, 0x00, 0x00, 0x03, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xff, 0x80, 0x00, 0x00, 
-0x00, 0x00, 0x03, 0xff, 0xc0, 0x00, 0x00, 0x00, 0x00, 0x03, 0xff, 0xc0, 0x00, 0x00, 0x00, 0x00, 
-0x87, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0xc7, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0xe7, 0xef, 
-0xf0, 0x00, 0x00, 0x00, 0x01, 0xff, 0xcf, 0xf1, 0x00, 0x00, 0x00, 0x01, 0xff, 0x8f, 0xf3, 0x00, 
-0x00, 0x00, 0x01, 0xff, 0x8f, 0xf3, 0x80, 0x00, 0x00, 0x03, 0xff, 0x0f, 0xf7, 0x80, 0x00, 0x00, 
-0x03, 0xff, 0x07, 0xff, 0x80, 0x00, 0x00, 0x03, 0xff, 0x03, 0xff, 0x80, 0x00, 0x00, 0x03, 0xff, 
-0x01, 0xff, 0x80, 0x00, 0x00, 0x07, 0xff, 0x00, 0xff, 0xc0, 0x00, 0x00, 0x07, 0xf3, 0x00, 0xff, 
-0xc0, 0x00, 0x00, 0x07, 0xf0, 0x00, 0xff, 0xc0, 0x00, 0x00, 0x07, 0xf0, 0x00, 0x5f, 0xc0, 0x00, 
-0x00, 0x03, 0xf0, 0x00, 0x1f, 0x80, 0x00, 0x00, 0x03, 0xe0, 0x00, 0x0f, 0x80, 0x00, 0x00, 0x03, 
-0xe0, 0x00, 0x0f, 0x80, 0x00, 0x00, 0x03, 0xe0, 0x00, 0x0f, 0x80, 0x00, 0x00, 0x01, 0xe0, 0x00, 
-0x0f, 0x00, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x00, 0x0e, 0x00, 
-0x00, 0x00, 0x00, 0x70, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0x18, 0x00, 0x00, 0x00, 
-0x00, 0x08, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-0x00, 0x00
+// Dot patterns of the two middle shades, worked out from the 8x8 Bayer
+// matrix
+//
+//      0 32  8 40  2 34 10 42
+//     48 16 56 24 50 18 58 26
+//     12 44  4 36 14 46  6 38
+//     60 28 52 20 62 30 54 22
+//      3 35 11 43  1 33  9 41
+//     51 19 59 27 49 17 57 25
+//     15 47  7 39 13 45  5 37
+//     63 31 55 23 61 29 53 21
+//
+// Shade s inks the pixels whose threshold t has 3 * t < 64 * s, a third
+// of them for shade 1 and two thirds for shade 2. dither_mask[s - 1][c]
+// is the matrix's column c as one framebuffer byte, row 0 in bit 7.
+static const uint8_t dither_mask[2][8] = {
+    { 0xaa, 0x44, 0xaa, 0x10, 0xaa, 0x44, 0xaa, 0x01 },
+    { 0xaa, 0xdd, 0xaa, 0xf7, 0xaa, 0xdd, 0xaa, 0xff },
 };
 
-const Img flame = {
-    .width= 55,
-    .height =46,
-    .pitch = 7,
-    .img_data = flame_data
+#define GRAY_CHUNK 64
+
+static uint8_t rotl8(uint8_t v, int n) {
+    return n ? (uint8_t)(v << n | v >> (8 - n)) : v;
+}
+
+// A PackBits stream decoded a chunk at a time; a run can end in the
+// middle of a chunk and carry on in the next one
+struct unpacker {
+    const uint8_t *src;
+    int left;     // bytes still to come from the current run
+    bool repeat;  // the run is one byte repeated, not a literal
 };
+
+static void unpack(struct unpacker *u, uint8_t *dst, int n) {
+    while (n > 0) {
+        if (u->left == 0) {
+            int8_t c = (int8_t)*u->src++;
+            if (c == -128) {
+                continue;
+            }
+            u->repeat = c < 0;
+            u->left = c < 0 ? 1 - c : c + 1;
+        }
+        int k = n < u->left ? n : u->left;
+        if (u->repeat) {
+            memset(dst, *u->src, k);
+        } else {
+            memcpy(dst, u->src, k);
+            u->src += k;
+        }
+        u->left -= k;
+        if (u->repeat && u->left == 0) {
+            u->src++;
+        }
+        dst += k;
+        n -= k;
+    }
+}
+
+// Where the PackBits stream after the n bytes src decodes to starts
+static const uint8_t *unpack_skip(const uint8_t *src, int n) {
+    while (n > 0) {
+        int8_t c = (int8_t)*src++;
+        if (c >= 0) {
+            src += c + 1;
+            n -= c + 1;
+        } else if (c != -128) {
+            src++;
+            n -= 1 - c;
+        }
+    }
+    return src;
+}
+
+// The matrix is tied to the screen, not to the image, so shades line up
+// across icons and stay put when one moves by a pixel. Each column of a
+// band is eight pixels dithered at once: a few ANDs and ORs of its two
+// planes with that column's patterns give the byte fb_blit_bytes() takes.
+static void draw_gray4(int x_offset, int y_offset, const Img *image) {
+    int width = image->pitch;
+    uint8_t light[8], dark[8];
+
+    // Turn the patterns so bit 7 is the band's top row wherever it lands
+    for (int i = 0; i < 8; i++) {
+        light[i] = rotl8(dither_mask[0][(x_offset + i) & 7], y_offset & 7);
+        dark[i] = rotl8(dither_mask[1][(x_offset + i) & 7], y_offset & 7);
+    }
+
+    // Both planes of a band are unpacked side by side, a chunk at a time;
+    // the low one starts where the high one's stream ends
+    struct unpacker hi = { .src = image->img_data };
+    struct unpacker lo;
+    for (int band = 0; band * 8 < image->height; band++, hi.src = lo.src) {
+        lo = (struct unpacker){ .src = unpack_skip(hi.src, width) };
+
+        for (int col = 0; col < width; col += GRAY_CHUNK) {
+            uint8_t h[GRAY_CHUNK], l[GRAY_CHUNK], out[GRAY_CHUNK];
+            int n = width - col < GRAY_CHUNK ? width - col : GRAY_CHUNK;
+
+            unpack(&hi, h, n);
+            unpack(&lo, l, n);
+            for (int i = 0; i < n; i++) {
+                int phase = (col + i) & 7;
+                // 3 is always black, 2 follows dark, 1 follows light
+                out[i] = (h[i] & (l[i] | dark[phase])) | (~h[i] & l[i] & light[phase]);
+            }
+            fb_blit_bytes(x_offset + col, y_offset + band * 8, out, n);
+        }
+    }
+}
+
+//image drawn method, used for raindrop and temperature icons
+void draw_my_image(int x_offset, int y_offset, const Img *image) {
+    if (image->encoding == IMG_RLE) {
+        draw_rle(x_offset, y_offset, image);
+        return;
+    }
+    if (image->encoding == IMG_GRAY4) {
+        draw_gray4(x_offset, y_offset, image);
+        return;
+    }
+
+    int width = image->width;
+    int height = image->height;
+    int bytes_per_row = image->pitch;  // (width + 7) / 8
+
+    for (int y = 0; y < height; y++) {
+        for (int byte_index = 0; byte_index < bytes_per_row; byte_index++) {
+            uint8_t byte = image->img_data[y * bytes_per_row + byte_index];
+            for (int bit = 0; bit < 8; bit++) {
+                int x = byte_index * 8 + bit;
+                if (x >= width) break;
+
+                if (byte & (0x80 >> bit)) {
+                    set_pixel(x + x_offset, y + y_offset);
+                }
+            }
+        }
+    }
+}
@@ -7,17 +7,41 @@
 extern "C" {
 #endif
 
+// How img_data is laid out
+typedef enum {
+    // Row-major, 1 bit per pixel, leftmost pixel in bit 7, pitch bytes
+    // per row
+    IMG_RAW,
+    // PackBits over bands of 8 rows in the display's own format: one
+    // byte per column, top pixel in bit 7, set bits black. Every band is
+    // compressed separately and decodes to pitch (= width) bytes.
+    IMG_RLE,
+    // Four shades, 0 (paper) to 3 (black), in the same bands of 8 rows:
+    // every band is two planes of pitch (= width) bytes, the high bit of
+    // each pixel's shade first, then the low bit, each PackBits-compressed
+    // on its own. Drawn with an ordered dither, so the middle shades
+    // become fixed dot patterns.
+    IMG_GRAY4,
+} ImgEncoding;
+
 // Define the Img struct type here
 typedef struct {
     int width;
     int height;
     int pitch;
     const uint8_t *img_data;
+    uint8_t encoding;    // ImgEncoding, IMG_RAW when left out
+    uint16_t data_size;  // bytes in img_data
 } Img;
 
 // Declare the image data and image instance
 // extern const uint8_t mario_image_data[];
 // extern const Img mario;
+extern const Img raindrop;
+extern const Img flame;
+
+// Draw an image with its top left corner at (x_offset, y_offset)
+void draw_my_image(int x_offset, int y_offset, const Img *image);
 
 #ifdef __cplusplus
 }
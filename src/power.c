@@ -0,0 +1,58 @@
+#include "power.h"
+#include "epd.h"
+#include "render.h"
+#include "tuning.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/pm/device.h>
+
+LOG_MODULE_REGISTER(power);
+
+// Longest a frame can take to reach the panel, a full refresh included
+#define FRAME_TIMEOUT K_SECONDS(10)
+
+#ifdef CONFIG_APP_SUSPEND_CONSOLE
+static const struct device *console = DEVICE_DT_GET(DT_CHOSEN(zephyr_console));
+#endif
+static int64_t cycle_start_ms;
+static uint64_t busy_cycles;
+
+void power_cycle_begin(void) {
+#ifdef CONFIG_APP_SUSPEND_CONSOLE
+    pm_device_action_run(console, PM_DEVICE_ACTION_RESUME);
+#endif
+    cycle_start_ms = k_uptime_get();
+}
+
+void power_cycle_end(uint32_t next_ms, bool posted) {
+#ifdef CONFIG_APP_POWER_BUDGET
+    k_thread_runtime_stats_t stats;
+    uint32_t active_ms = (uint32_t)(k_uptime_get() - cycle_start_ms);
+
+    k_thread_runtime_stats_all_get(&stats);
+    uint32_t cpu_us = (uint32_t)k_cyc_to_us_floor64(stats.total_cycles - busy_cycles);
+    uint32_t panel_ms = epd_take_busy_ms();
+    busy_cycles = stats.total_cycles;
+
+    // CPU time counts every thread since the last report, so the frame
+    // of the previous cycle is included; the panel is busy on its own
+    if (!tuning_quiet()) {
+        LOG_INF("Cycle: %u ms awake, CPU %u.%03u ms, panel %u ms, next in %u ms",
+                active_ms, cpu_us / 1000, cpu_us % 1000, panel_ms, next_ms);
+    }
+#endif
+
+#ifdef CONFIG_APP_SUSPEND_CONSOLE
+    // Let the frame and its log output through before the UART goes down;
+    // a cycle without a reading has no frame to wait for
+    if (posted) {
+        render_wait(FRAME_TIMEOUT);
+    }
+    epd_wait_idle(FRAME_TIMEOUT);
+    while (log_data_pending()) {
+        k_msleep(1);
+    }
+    pm_device_action_run(console, PM_DEVICE_ACTION_SUSPEND);
+#endif
+}
@@ -0,0 +1,21 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Power handling around the sample cycle: the console UART suspended
+// between cycles, and a per-cycle report of how long the CPU and the
+// panel were active. spi0 needs nothing here, runtime PM suspends it
+// after every transfer. The panel controller stays powered: the
+// ssd16xx driver has no PM support and never sends it to deep sleep.
+
+// Start of a sample cycle, powers the console back up
+void power_cycle_begin(void);
+
+// End of a sample cycle: logs the active-time budget and suspends the
+// console until the next cycle. posted tells whether the cycle handed a
+// reading to the render thread, whose frame is waited for first.
+void power_cycle_end(uint32_t next_ms, bool posted);
+
+#endif // POWER_H
@@ -0,0 +1,120 @@
+#include "prof.h"
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+// Log-linear histogram of microseconds: values below 4 get a bucket
+// each, above that every power of two is split into 4 buckets, so a
+// percentile is known to within 25%. 108 buckets reach past 4 minutes.
+#define SUB_BITS 2
+#define BUCKETS  108
+
+struct stage_stats {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t hist[BUCKETS];
+};
+
+static const char *const stage_names[PROF_STAGES] = {
+    [PROF_FETCH] = "fetch",
+    [PROF_FORMAT] = "format",
+    [PROF_DRAW] = "draw",
+    [PROF_PACK] = "pack",
+    [PROF_WRITE] = "write",
+    [PROF_FRAME] = "frame",
+};
+
+static struct stage_stats stats[PROF_STAGES];
+static struct k_spinlock lock;
+
+static int bucket_of(uint32_t us) {
+    if (us < (1 << SUB_BITS)) {
+        return us;
+    }
+    int msb = 31 - __builtin_clz(us);
+    int b = (msb - SUB_BITS + 1) << SUB_BITS | ((us >> (msb - SUB_BITS)) & ((1 << SUB_BITS) - 1));
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+// Largest value that lands in bucket b
+static uint32_t bucket_top(int b) {
+    if (b < (1 << SUB_BITS)) {
+        return b;
+    }
+    int shift = (b >> SUB_BITS) - 1;
+    uint32_t base = (1 << SUB_BITS) | (b & ((1 << SUB_BITS) - 1));
+    return ((base + 1) << shift) - 1;
+}
+
+void prof_record(enum prof_stage stage, timing_t start, timing_t end) {
+    uint64_t ns = timing_cycles_to_ns(timing_cycles_get(&start, &end));
+    uint32_t us = ns / 1000 > UINT32_MAX ? UINT32_MAX : (uint32_t)(ns / 1000);
+    struct stage_stats *s = &stats[stage];
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (s->count == 0 || us < s->min_us) s->min_us = us;
+    if (us > s->max_us) s->max_us = us;
+    s->sum_us += us;
+    s->count++;
+    s->hist[bucket_of(us)]++;
+    k_spin_unlock(&lock, key);
+}
+
+static uint32_t percentile(const struct stage_stats *s, int pct) {
+    uint32_t want = (s->count * pct + 99) / 100;
+    uint32_t seen = 0;
+
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += s->hist[b];
+        if (seen >= want) {
+            uint32_t top = bucket_top(b);
+            return top < s->max_us ? top : s->max_us;
+        }
+    }
+    return s->max_us;
+}
+
+static int cmd_prof_show(const struct shell *sh, size_t argc, char **argv) {
+    shell_print(sh, "%-8s %8s %9s %9s %9s %9s", "stage", "count", "min us", "avg us", "p99 us",
+                "max us");
+    for (int i = 0; i < PROF_STAGES; i++) {
+        struct stage_stats s;
+        k_spinlock_key_t key = k_spin_lock(&lock);
+        s = stats[i];
+        k_spin_unlock(&lock, key);
+
+        if (s.count == 0) {
+            shell_print(sh, "%-8s %8u", stage_names[i], 0);
+            continue;
+        }
+        shell_print(sh, "%-8s %8u %9u %9u %9u %9u", stage_names[i], s.count, s.min_us,
+                    (uint32_t)(s.sum_us / s.count), percentile(&s, 99), s.max_us);
+    }
+    return 0;
+}
+
+static int cmd_prof_reset(const struct shell *sh, size_t argc, char **argv) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    memset(stats, 0, sizeof(stats));
+    k_spin_unlock(&lock, key);
+    shell_print(sh, "Timings cleared");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(prof_cmds,
+    SHELL_CMD(reset, NULL, "Clear all timings", cmd_prof_reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_SUBCMD_ADD((tempdemo), prof, &prof_cmds, "Per-stage timings (min/avg/p99/max)",
+                 cmd_prof_show, 1, 0);
+
+static int prof_init(void) {
+    timing_init();
+    timing_start();
+    return 0;
+}
+
+SYS_INIT(prof_init, APPLICATION, 0);
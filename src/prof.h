@@ -0,0 +1,30 @@
+#ifndef PROF_H
+#define PROF_H
+
+// Timing spans for the sample -> render -> refresh path. With
+// CONFIG_APP_PROFILING off the macros expand to nothing, so they can stay
+// in hot code (including the parts built for the host).
+
+enum prof_stage {
+    PROF_FETCH,   // sensor read
+    PROF_FORMAT,  // working out which widgets changed, value formatting
+    PROF_DRAW,    // drawing into the framebuffer
+    PROF_PACK,    // copying frames and windows into transfer buffers
+    PROF_WRITE,   // display_write() and friends, BUSY waits included
+    PROF_FRAME,   // one reading through the render thread
+    PROF_STAGES,
+};
+
+#ifdef CONFIG_APP_PROFILING
+#include <zephyr/timing/timing.h>
+
+void prof_record(enum prof_stage stage, timing_t start, timing_t end);
+
+#define PROF_BEGIN(var) timing_t var = timing_counter_get()
+#define PROF_END(stage, var) prof_record((stage), var, timing_counter_get())
+#else
+#define PROF_BEGIN(var) do { } while (0)
+#define PROF_END(stage, var) do { } while (0)
+#endif
+
+#endif // PROF_H
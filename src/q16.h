@@ -0,0 +1,19 @@
+#ifndef Q16_H
+#define Q16_H
+
+#include <stdint.h>
+
+// Signed 16.16 fixed point
+typedef int32_t q16_t;
+
+#define Q16_ONE        (1 << 16)
+#define Q16_FROM_INT(i) ((q16_t)((i) * Q16_ONE))
+
+// Round a Q16 value to hundredths, e.g. 23.456 -> 2346
+static inline int32_t q16_to_centi(q16_t v) {
+    int64_t scaled = (int64_t)v * 100;
+    return (int32_t)(scaled >= 0 ? (scaled + Q16_ONE / 2) >> 16
+                                 : -((-scaled + Q16_ONE / 2) >> 16));
+}
+
+#endif // Q16_H
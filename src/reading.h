@@ -0,0 +1,27 @@
+#ifndef READING_H
+#define READING_H
+
+#include <stdint.h>
+#include <zephyr/drivers/sensor.h>
+
+// One sample of a location, fused from its probes
+struct reading {
+    struct sensor_value temp;
+    struct sensor_value humidity;
+    int64_t uptime_ms;  // when the sample was taken
+    uint8_t location;   // 0 is the primary one, the one history is kept for
+    uint8_t locations;  // how many there are
+    const char *name;   // location label, "" when there is only one
+};
+
+// A sensor_value in hundredths, e.g. 23.456 -> 2345
+static inline int16_t sensor_value_to_centi(const struct sensor_value *v) {
+    return (int16_t)(v->val1 * 100 + v->val2 / 10000);
+}
+
+static inline void sensor_value_from_centi(struct sensor_value *v, int16_t centi) {
+    v->val1 = centi / 100;
+    v->val2 = centi % 100 * 10000;
+}
+
+#endif // READING_H
@@ -0,0 +1,212 @@
+#include "render.h"
+#include "ble_ess.h"
+#include "comfort.h"
+#include "datalog.h"
+#include "epd.h"
+#include "history.h"
+#include "prof.h"
+#include "sensors.h"
+#include "tuning.h"
+#include "ui.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#define RENDER_STACK_SIZE 2048
+#define RENDER_PRIORITY   7
+
+// Room for every location's reading of a cycle, and a few spare
+K_MSGQ_DEFINE(render_queue, sizeof(struct reading), SENSORS_LOCATIONS + 3, 4);
+K_SEM_DEFINE(render_done, 0, 1);
+// Readings posted, and handled or dropped, since boot; render_wait()
+// waits for the second to catch up with the first
+static atomic_t posted;
+static atomic_t handled;
+K_MUTEX_DEFINE(history_lock);
+K_THREAD_STACK_DEFINE(render_stack, RENDER_STACK_SIZE);
+static struct k_thread render_thread_data;
+
+// Newest reading of every location and what was derived from it, kept
+// for render_get_latest()
+static struct reading latest[SENSORS_LOCATIONS];
+static struct comfort comforts[SENSORS_LOCATIONS];
+static struct k_spinlock latest_lock;
+
+void render_record(const struct reading *reading) {
+    const int16_t value[HISTORY_CHANNELS] = {
+        [HISTORY_TEMP] = sensor_value_to_centi(&reading->temp),
+        [HISTORY_HUMIDITY] = sensor_value_to_centi(&reading->humidity),
+    };
+    uint32_t time_s = (uint32_t)(reading->uptime_ms / 1000);
+
+    k_mutex_lock(&history_lock, K_FOREVER);
+    history_add(time_s, value);
+    k_mutex_unlock(&history_lock);
+#ifdef CONFIG_APP_DATALOG
+    datalog_add(time_s, value);
+#endif
+}
+
+// Newest history bucket, the one the graph ends with; UINT32_MAX before
+// the first sample
+static uint32_t newest_bucket(void) {
+    uint32_t seq;
+
+    k_mutex_lock(&history_lock, K_FOREVER);
+    int err = history_newest_bucket(&seq);
+    k_mutex_unlock(&history_lock);
+    return err ? UINT32_MAX : seq;
+}
+
+// Bring the layout in line with the thresholds set at run time
+static void apply_tuning(void) {
+    for (int f = 0; f < UI_FIELD_COUNT; f++) {
+        q16_t min;
+        if (tuning_get_threshold(f, &min)) {
+            ui_set_threshold(f, min);
+        }
+    }
+}
+
+static void render_reading(const struct reading *reading) {
+    static uint32_t tuned = UINT32_MAX;  // tuning generation applied
+    static int shift = 1;          // flipped to 0 by the first repaint
+    static int panel;              // location on screen
+    static int drawn_panel = -1;
+    static uint32_t drawn_bucket = UINT32_MAX;  // newest bucket on the graph
+    static bool retuned;           // held until the next frame
+    struct comfort *comfort = &comforts[reading->location];
+    struct comfort updated = *comfort;
+
+    // The sample loop has recorded the reading already, so the history
+    // has no gaps when readings are dropped here. Bluetooth follows the
+    // primary location; with several locations the panels take turns,
+    // one per sample cycle.
+    if (reading->location == 0) {
+        panel = (panel + 1) % reading->locations;
+    }
+    bool new_bucket = newest_bucket() != drawn_bucket;
+    bool changed = comfort_update(&updated, &reading->temp, &reading->humidity);
+
+    k_spinlock_key_t key = k_spin_lock(&latest_lock);
+    latest[reading->location] = *reading;
+    *comfort = updated;
+    k_spin_unlock(&latest_lock, key);
+
+    if (tuned != tuning_generation()) {
+        tuned = tuning_generation();
+        apply_tuning();
+        retuned = true;
+    }
+
+#ifdef CONFIG_APP_BLE
+    if (changed && reading->location == 0) {
+        ble_ess_update(comfort);
+    }
+#endif
+
+    // The graph scrolls with every new bucket, even when the values hold
+    if (reading->location != panel ||
+        (!changed && !new_bucket && !retuned && panel == drawn_panel)) {
+        return;
+    }
+
+    if (!tuning_quiet()) {
+        printk("%s%sTemp: %d.%06d C, Humidity: %d.%06d%%\n", reading->name, *reading->name ? ": " : "",
+               reading->temp.val1, reading->temp.val2, reading->humidity.val1,
+               reading->humidity.val2);
+        printk("Heat Index: %d C, Dew point: %d C\n", q16_to_centi(comfort->heat_index_c) / 100,
+               q16_to_centi(comfort->dew_point_c) / 100);
+    }
+
+    const q16_t values[UI_FIELD_COUNT] = {
+        [UI_TEMP_C] = comfort->temp_c,
+        [UI_TEMP_F] = comfort->temp_f,
+        [UI_HUMIDITY] = comfort->humidity,
+        [UI_HEAT_INDEX_C] = comfort->heat_index_c,
+        [UI_DEW_POINT_C] = comfort->dew_point_c,
+    };
+
+    // A full refresh repaints everything anyway, which is also when the
+    // layout moves by a pixel to spread out burn-in
+    bool repaint = epd_full_refresh_due();
+    struct framebuffer *fb = epd_acquire();
+    if (repaint) {
+        shift = !shift;
+        ui_set_offset(shift, shift);
+        ui_repaint();
+    }
+    ui_set_title(reading->name);
+    ui_update(values);
+    epd_submit(fb);
+    drawn_panel = panel;
+    drawn_bucket = newest_bucket();
+    retuned = false;
+}
+
+static void render_thread(void *p1, void *p2, void *p3) {
+    struct reading reading;
+
+    while (1) {
+        k_msgq_get(&render_queue, &reading, K_FOREVER);
+        PROF_BEGIN(t_frame);
+        render_reading(&reading);
+        PROF_END(PROF_FRAME, t_frame);
+        atomic_inc(&handled);
+        k_sem_give(&render_done);
+    }
+}
+
+void render_start(void) {
+    k_thread_create(&render_thread_data, render_stack, K_THREAD_STACK_SIZEOF(render_stack),
+                    render_thread, NULL, NULL, NULL, RENDER_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&render_thread_data, "render");
+}
+
+void render_post(const struct reading *reading) {
+    atomic_inc(&posted);
+    while (k_msgq_put(&render_queue, reading, K_NO_WAIT) != 0) {
+        struct reading stale;
+        if (k_msgq_get(&render_queue, &stale, K_NO_WAIT) == 0) {
+            atomic_inc(&handled);
+        }
+    }
+}
+
+int render_wait(k_timeout_t timeout) {
+    k_timepoint_t end = sys_timepoint_calc(timeout);
+    atomic_val_t target = atomic_get(&posted);
+
+    // render_done only wakes us up; it may still be given from a frame
+    // nobody waited for
+    while (atomic_get(&handled) < target) {
+        if (k_sem_take(&render_done, sys_timepoint_timeout(end)) != 0) {
+            return -EAGAIN;
+        }
+    }
+    return 0;
+}
+
+int render_get_latest(int location, struct reading *reading, struct comfort *comfort) {
+    int err = -ENODATA;
+
+    if (location < 0 || location >= SENSORS_LOCATIONS) {
+        return -EINVAL;
+    }
+    k_spinlock_key_t key = k_spin_lock(&latest_lock);
+    if (comforts[location].valid) {
+        *reading = latest[location];
+        *comfort = comforts[location];
+        err = 0;
+    }
+    k_spin_unlock(&latest_lock, key);
+    return err;
+}
+
+void render_lock_history(void) {
+    k_mutex_lock(&history_lock, K_FOREVER);
+}
+
+void render_unlock_history(void) {
+    k_mutex_unlock(&history_lock);
+}
@@ -0,0 +1,35 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <zephyr/kernel.h>
+#include "comfort.h"
+#include "reading.h"
+
+// Start the thread that turns readings into frames for the panel
+void render_start(void);
+
+// Add a reading of the primary location to the history and the flash
+// log. The sample loop calls it before render_post(), so every reading is
+// kept even when the render thread drops it.
+void render_record(const struct reading *reading);
+
+// Hand a reading to the render thread without blocking. If the thread
+// is behind (say, waiting on a slow full refresh) the stale readings are
+// dropped, only the newest ones matter for the screen.
+void render_post(const struct reading *reading);
+
+// Wait until the render thread has handled every reading posted so far,
+// the whole batch of a sample cycle (and handed the frames to the panel,
+// if anything changed). -EAGAIN on timeout.
+int render_wait(k_timeout_t timeout);
+
+// Copy the newest reading of a location and the values derived from it.
+// -ENODATA until the location had a reading, -EINVAL past the last one.
+int render_get_latest(int location, struct reading *reading, struct comfort *comfort);
+
+// The history is written by render_record(); other threads hold this
+// lock while they read it
+void render_lock_history(void);
+void render_unlock_history(void);
+
+#endif // RENDER_H
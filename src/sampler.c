@@ -0,0 +1,49 @@
+#include "sampler.h"
+
+// Smallest change per channel worth a new sample, in hundredths
+static const int16_t step[HISTORY_CHANNELS] = {
+    [HISTORY_TEMP] = 10,
+    [HISTORY_HUMIDITY] = 100,
+};
+
+void sampler_init(struct sampler *s, uint32_t min_ms, uint32_t max_ms) {
+    s->min_ms = min_ms;
+    s->max_ms = max_ms;
+    s->period_ms = min_ms;
+    s->valid = false;
+}
+
+void sampler_set_limits(struct sampler *s, uint32_t min_ms, uint32_t max_ms) {
+    s->min_ms = min_ms;
+    s->max_ms = max_ms;
+    if (s->period_ms < min_ms) s->period_ms = min_ms;
+    if (s->period_ms > max_ms) s->period_ms = max_ms;
+}
+
+uint32_t sampler_next(struct sampler *s, int64_t now_ms, const int16_t value[HISTORY_CHANNELS]) {
+    if (s->valid) {
+        // Change since the last sample in steps, of the faster channel
+        int steps = 0;
+        for (int c = 0; c < HISTORY_CHANNELS; c++) {
+            int d = value[c] - s->last[c];
+            int n = (d < 0 ? -d : d) / step[c];
+            if (n > steps) {
+                steps = n;
+            }
+        }
+
+        uint64_t elapsed = (uint64_t)(now_ms - s->last_ms);
+        uint64_t period = steps > 0 ? elapsed / steps : (uint64_t)s->period_ms * 3 / 2;
+
+        if (period < s->min_ms) period = s->min_ms;
+        if (period > s->max_ms) period = s->max_ms;
+        s->period_ms = (uint32_t)period;
+    }
+
+    for (int c = 0; c < HISTORY_CHANNELS; c++) {
+        s->last[c] = value[c];
+    }
+    s->last_ms = now_ms;
+    s->valid = true;
+    return s->period_ms;
+}
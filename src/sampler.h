@@ -0,0 +1,38 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "history.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Picks the time to the next sample from how fast the readings move:
+// about one display step (0.1 C or 1 %RH) of change per sample, never
+// faster than min_ms and never slower than max_ms. Steady readings back
+// off gradually.
+struct sampler {
+    uint32_t min_ms;
+    uint32_t max_ms;
+
+    uint32_t period_ms;
+    bool valid;
+    int64_t last_ms;
+    int16_t last[HISTORY_CHANNELS];
+};
+
+void sampler_init(struct sampler *s, uint32_t min_ms, uint32_t max_ms);
+
+// Change the limits, the current period is moved into them
+void sampler_set_limits(struct sampler *s, uint32_t min_ms, uint32_t max_ms);
+
+// Feed the sample just taken, returns the delay to the next one
+uint32_t sampler_next(struct sampler *s, int64_t now_ms, const int16_t value[HISTORY_CHANNELS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLER_H
@@ -0,0 +1,199 @@
+#include "sensors.h"
+#include "dht_capture.h"
+#include "fusion.h"
+#include <errno.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(sensors);
+
+#define FETCH_STACK_SIZE 1024
+#define FETCH_PRIORITY   5
+
+struct probe {
+    const char *name;
+    uint32_t ord;               // devicetree dependency ordinal
+    const struct device *dev;   // read through the sensor API, or
+    struct dht_capture *dht;    // by edge capture
+    uint8_t location;
+    bool ready;
+
+    // Result of the current batch
+    int err;
+    int16_t temp;
+    int16_t humidity;
+    struct k_work work;
+};
+
+#define PROBE_INIT(node, dev_, dht_) \
+    { .name = DT_NODE_FULL_NAME(node), .ord = DT_DEP_ORD(node), .dev = (dev_), .dht = (dht_) },
+#define DEVICE_PROBE(node) PROBE_INIT(node, DEVICE_DT_GET(node), NULL)
+
+// DHTs are edge captured unless the Zephyr driver is used instead
+#ifdef CONFIG_APP_DHT_EDGE_CAPTURE
+#define DHT_DEFINE(node) \
+    static struct dht_capture _CONCAT(dht_, DT_DEP_ORD(node)) = DHT_CAPTURE_DT_INIT(node);
+#define DHT_PROBE(node) PROBE_INIT(node, NULL, &_CONCAT(dht_, DT_DEP_ORD(node)))
+DT_FOREACH_STATUS_OKAY(aosong_dht, DHT_DEFINE)
+#else
+#define DHT_PROBE DEVICE_PROBE
+#endif
+
+// Sensors with both SENSOR_CHAN_AMBIENT_TEMP and SENSOR_CHAN_HUMIDITY
+static struct probe probes[] = {
+    DT_FOREACH_STATUS_OKAY(aosong_dht, DHT_PROBE)
+    DT_FOREACH_STATUS_OKAY(sensirion_sht3xd, DEVICE_PROBE)
+    DT_FOREACH_STATUS_OKAY(sensirion_sht4x, DEVICE_PROBE)
+    DT_FOREACH_STATUS_OKAY(sensirion_shtcx, DEVICE_PROBE)
+    DT_FOREACH_STATUS_OKAY(bosch_bme280, DEVICE_PROBE)
+    DT_FOREACH_STATUS_OKAY(silabs_si7006, DEVICE_PROBE)
+    DT_FOREACH_STATUS_OKAY(ti_hdc, DEVICE_PROBE)
+};
+#define PROBE_COUNT ARRAY_SIZE(probes)
+
+struct location {
+    const char *name;
+    const uint32_t *ords;       // probes listed by the node
+    int count;
+};
+
+#define SENSOR_ORD(node, prop, idx) DT_DEP_ORD(DT_PHANDLE_BY_IDX(node, prop, idx)),
+#define LOCATION_ORDS(node) \
+    static const uint32_t _CONCAT(ords_, DT_DEP_ORD(node))[] = { \
+        DT_FOREACH_PROP_ELEM(node, sensors, SENSOR_ORD) \
+    };
+#define LOCATION_INIT(node) \
+    { .name = DT_PROP(node, label), .ords = _CONCAT(ords_, DT_DEP_ORD(node)), \
+      .count = DT_PROP_LEN(node, sensors) },
+
+DT_FOREACH_STATUS_OKAY(tempdemo_location, LOCATION_ORDS)
+static const struct location locations[SENSORS_LOCATIONS] = {
+#if DT_HAS_COMPAT_STATUS_OKAY(tempdemo_location)
+    DT_FOREACH_STATUS_OKAY(tempdemo_location, LOCATION_INIT)
+#else
+    { .name = "" },
+#endif
+};
+
+K_THREAD_STACK_DEFINE(fetch_stack, FETCH_STACK_SIZE);
+static struct k_work_q fetch_queue;
+static K_SEM_DEFINE(batch_done, 0, PROBE_COUNT > 0 ? PROBE_COUNT : 1);
+
+static void fetch_work(struct k_work *work) {
+    struct probe *p = CONTAINER_OF(work, struct probe, work);
+    struct sensor_value temp, humidity;
+
+    p->err = sensor_sample_fetch(p->dev);
+    if (!p->err) {
+        p->err = sensor_channel_get(p->dev, SENSOR_CHAN_AMBIENT_TEMP, &temp);
+    }
+    if (!p->err) {
+        p->err = sensor_channel_get(p->dev, SENSOR_CHAN_HUMIDITY, &humidity);
+    }
+    if (!p->err) {
+        p->temp = sensor_value_to_centi(&temp);
+        p->humidity = sensor_value_to_centi(&humidity);
+    }
+    k_sem_give(&batch_done);
+}
+
+static uint8_t location_of(const struct probe *p) {
+    for (int l = 0; l < SENSORS_LOCATIONS; l++) {
+        for (int i = 0; i < locations[l].count; i++) {
+            if (locations[l].ords[i] == p->ord) {
+                return l;
+            }
+        }
+    }
+    return 0;
+}
+
+int sensors_init(void) {
+    int ready = 0;
+
+    for (size_t i = 0; i < PROBE_COUNT; i++) {
+        struct probe *p = &probes[i];
+
+        if (p->dht) {
+            p->ready = dht_capture_init(p->dht) == 0;
+        } else {
+            p->ready = device_is_ready(p->dev);
+            k_work_init(&p->work, fetch_work);
+        }
+        p->location = location_of(p);
+        LOG_INF("%s: %s, location %u", p->name, p->ready ? "ready" : "not ready", p->location);
+        ready += p->ready;
+    }
+    if (ready == 0) {
+        return -ENODEV;
+    }
+
+    k_work_queue_init(&fetch_queue);
+    k_work_queue_start(&fetch_queue, fetch_stack, K_THREAD_STACK_SIZEOF(fetch_stack),
+                       FETCH_PRIORITY, NULL);
+    k_thread_name_set(&fetch_queue.thread, "fetch");
+    return 0;
+}
+
+uint32_t sensors_read(struct reading out[SENSORS_LOCATIONS]) {
+    int pending = 0;
+
+    // Start the sensor API probes first: their conversions run on the
+    // fetch thread while the DHT captures below sleep through theirs
+    for (size_t i = 0; i < PROBE_COUNT; i++) {
+        struct probe *p = &probes[i];
+        p->err = -ENODEV;
+        if (p->ready && p->dev) {
+            k_work_submit_to_queue(&fetch_queue, &p->work);
+            pending++;
+        }
+    }
+    for (size_t i = 0; i < PROBE_COUNT; i++) {
+        struct probe *p = &probes[i];
+        struct sensor_value temp, humidity;
+
+        if (p->ready && p->dht) {
+            p->err = dht_capture_fetch(p->dht, &temp, &humidity);
+            if (!p->err) {
+                p->temp = sensor_value_to_centi(&temp);
+                p->humidity = sensor_value_to_centi(&humidity);
+            }
+        }
+    }
+    // Drivers time out on a dead bus themselves
+    while (pending-- > 0) {
+        k_sem_take(&batch_done, K_FOREVER);
+    }
+
+    uint32_t valid = 0;
+    int64_t now = k_uptime_get();
+    for (int l = 0; l < SENSORS_LOCATIONS; l++) {
+        int16_t temp[PROBE_COUNT], humidity[PROBE_COUNT];
+        int n = 0;
+
+        for (size_t i = 0; i < PROBE_COUNT; i++) {
+            if (probes[i].location == l && probes[i].err == 0) {
+                temp[n] = probes[i].temp;
+                humidity[n] = probes[i].humidity;
+                n++;
+            } else if (probes[i].location == l && probes[i].ready) {
+                LOG_DBG("%s: read failed (%d)", probes[i].name, probes[i].err);
+            }
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        sensor_value_from_centi(&out[l].temp, fuse(temp, n, CONFIG_APP_FUSION_TEMP_MAX_DEV));
+        sensor_value_from_centi(&out[l].humidity,
+                                fuse(humidity, n, CONFIG_APP_FUSION_HUMIDITY_MAX_DEV));
+        out[l].uptime_ms = now;
+        out[l].location = l;
+        out[l].locations = SENSORS_LOCATIONS;
+        out[l].name = locations[l].name;
+        valid |= BIT(l);
+    }
+    return valid;
+}
@@ -0,0 +1,24 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <stdint.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+#include "reading.h"
+
+// Every temperature/humidity probe in the devicetree, read together once
+// per sample cycle and fused per location ("tempdemo,location" nodes).
+// Probes on the sensor API (SHT3x, SHT4x, BME280, ...) convert on a
+// fetch thread while the DHTs are captured on the caller's, so their
+// conversion times overlap.
+
+#define SENSORS_LOCATIONS MAX(1, DT_NUM_INST_STATUS_OKAY(tempdemo_location))
+
+// Check the probes and work out their locations; fails when none is ready
+int sensors_init(void);
+
+// Read all probes and fuse them into one reading per location. Returns a
+// mask of the locations that got a reading (bit 0: out[0] and so on).
+uint32_t sensors_read(struct reading out[SENSORS_LOCATIONS]);
+
+#endif // SENSORS_H
@@ -1,10 +1,39 @@
 #include "text.h"
+#include "framebuffer.h"
+#include "bitops.h"
 #include <stdint.h>
 
-extern void set_pixel(int x, int y);
-
-// Existing 5x7 font data: 5 columns, 7 rows (1 byte per column)
-static const uint8_t font_5x7[][5] = {
+// Glyph index maps: every ASCII code resolves to a glyph, characters a
+// font does not have fall back to glyph 0, which is a blank space in
+// every font. ',' is drawn as the degree sign ("23.45,C" -> 23.45°C).
+#define MAP_DIGITS(base) \
+    ['0'] = (base) + 0, ['1'] = (base) + 1, ['2'] = (base) + 2, \
+    ['3'] = (base) + 3, ['4'] = (base) + 4, ['5'] = (base) + 5, \
+    ['6'] = (base) + 6, ['7'] = (base) + 7, ['8'] = (base) + 8, \
+    ['9'] = (base) + 9
+#define MAP_UPPER(base) \
+    ['A'] = (base) + 0, ['B'] = (base) + 1, ['C'] = (base) + 2, \
+    ['D'] = (base) + 3, ['E'] = (base) + 4, ['F'] = (base) + 5, \
+    ['G'] = (base) + 6, ['H'] = (base) + 7, ['I'] = (base) + 8, \
+    ['J'] = (base) + 9, ['K'] = (base) + 10, ['L'] = (base) + 11, \
+    ['M'] = (base) + 12, ['N'] = (base) + 13, ['O'] = (base) + 14, \
+    ['P'] = (base) + 15, ['Q'] = (base) + 16, ['R'] = (base) + 17, \
+    ['S'] = (base) + 18, ['T'] = (base) + 19, ['U'] = (base) + 20, \
+    ['V'] = (base) + 21, ['W'] = (base) + 22, ['X'] = (base) + 23, \
+    ['Y'] = (base) + 24, ['Z'] = (base) + 25
+#define MAP_LOWER(base) \
+    ['a'] = (base) + 0, ['b'] = (base) + 1, ['c'] = (base) + 2, \
+    ['d'] = (base) + 3, ['e'] = (base) + 4, ['f'] = (base) + 5, \
+    ['g'] = (base) + 6, ['h'] = (base) + 7, ['i'] = (base) + 8, \
+    ['j'] = (base) + 9, ['k'] = (base) + 10, ['l'] = (base) + 11, \
+    ['m'] = (base) + 12, ['n'] = (base) + 13, ['o'] = (base) + 14, \
+    ['p'] = (base) + 15, ['q'] = (base) + 16, ['r'] = (base) + 17, \
+    ['s'] = (base) + 18, ['t'] = (base) + 19, ['u'] = (base) + 20, \
+    ['v'] = (base) + 21, ['w'] = (base) + 22, ['x'] = (base) + 23, \
+    ['y'] = (base) + 24, ['z'] = (base) + 25
+
+// 5x7 font data: 5 columns, 7 rows (1 byte per column, bit 0 = top pixel)
+static const uint8_t font_5x7_glyphs[][5] = {
     // SPACE (ASCII 32)
     {0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
     // !
@@ -88,39 +117,26 @@ static const uint8_t font_5x7[][5] = {
 
 };
 
+static const uint8_t font_5x7_map[128] = {
+    [' '] = 0, ['!'] = 1,
+    MAP_UPPER(2),
+    MAP_LOWER(28),
+    ['.'] = 54, [','] = 55,
+    MAP_DIGITS(56),
+};
 
-// Draw char from 5x7 font
-void draw_char_5x7(char c, int x, int y) {
-    uint8_t index;
-    if (c == ' ') index = 0;
-    else if (c == '!') index = 1;
-    else if (c >= 'A' && c <= 'Z') index = 2 + (c - 'A');
-    else if (c >= 'a' && c <= 'z') index = 28 + (c - 'a');
-    else if(c=='.') index =54;
-    else if(c==',') index=55;
-    else if (c>='0'&& c<='9') index = 56+ (c-'0');
-    else return;
-
-    for (int col = 0; col < 5; col++) {
-        uint8_t line = font_5x7[index][col];
-        for (int row = 0; row < 7; row++) {
-            if (line & (1 << row)) {
-                set_pixel(x + col, y + row);
-            }
-        }
-    }
-}
+const Font font_5x7 = {
+    .width = 5,
+    .height = 7,
+    .advance = 6,
+    .orientation = FONT_COLUMNS_LSB_TOP,
+    .stride = sizeof(font_5x7_glyphs[0]),
+    .glyphs = &font_5x7_glyphs[0][0],
+    .map = font_5x7_map,
+};
 
-// Draw string using 5x7 font
-void draw_string_5x7(const char *text, int x, int y) {
-    while (*text) {
-        draw_char_5x7(*text, x, y);
-        x += 6; // 5 columns + 1 spacing
-        text++;
-    }
-}
-// 7 columns per char, 9 rows (bits 0-8), bit 0 = top pixel, bit 8 = bottom pixel
-static const uint8_t font_7x9[][8] = {
+// 8 columns per char, 8 rows (1 byte per row, bit 7 = left pixel)
+static const uint8_t font_7x9_glyphs[][8] = {
     // SPACE (ASCII 32)
     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // ' '
     // !
@@ -196,53 +212,26 @@ static const uint8_t font_7x9[][8] = {
     { 0x06, 0x09, 0x09, 0x06, 0x00, 0x00, 0x00}  //degree symbol
 };
 
-void draw_char_7x9(char c, int x, int y) {
-    uint8_t index;
-
-    if (c == ' ') {
-        index = 0;
-    } else if (c == '!') {
-        index = 1;
-    } else if (c >= '0' && c <= '9') {
-        index = 2 + (c - '0');  // digits 0-9 at indices 2 to 11
-    } else if (c >= 'A' && c <= 'Z') {
-        index = 12 + (c - 'A');  // letters A-Z start at index 12
-    } else if (c >= 'a' && c <= 'z') {
-        index = 38 + (c - 'a');  // letters a-z start at index 38 (12 + 26)
-
-    } 
-    else if (c == '.') {
-    index = 64;
-    }
-    else if (c==','){
-        index = 65;
-    }    
-    else {
-        return;  // Unsupported character
-    }
-
-    for (int row = 0; row < 8; row++) {
-        uint8_t line = font_7x9[index][row];
-        for (int col = 0; col < 8; col++) {
-            if (line & (1 << (7 - col))) {
-                set_pixel(x + col, y + row);
-            }
-        }
-    }
-}
+static const uint8_t font_7x9_map[128] = {
+    [' '] = 0, ['!'] = 1,
+    MAP_DIGITS(2),
+    MAP_UPPER(12),
+    MAP_LOWER(38),
+    ['.'] = 64, [','] = 65,
+};
 
-void draw_string_7x9(const char *text, int x, int y) {
-    while (*text) {
-        draw_char_7x9(*text, x, y);
-        x += 9;  // 8 pixels wide + 1 pixel space
-        text++;
-    }
-}
+const Font font_7x9 = {
+    .width = 8,
+    .height = 8,
+    .advance = 9,
+    .orientation = FONT_ROWS_MSB_LEFT,
+    .stride = sizeof(font_7x9_glyphs[0]),
+    .glyphs = &font_7x9_glyphs[0][0],
+    .map = font_7x9_map,
+};
 
-// 8x12 font, uppercase A-Z
-// Each character: 8 columns, 12 rows (bit 0=top pixel, bit 11=bottom pixel)
-// Each uint16_t = one column's vertical pixels
-static const uint8_t font_8x10[][10] = {
+// 8 columns per char, 10 rows (1 byte per row, bit 7 = left pixel)
+static const uint8_t font_8x10_glyphs[][10] = {
     // SPACE
     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // ' '
 
@@ -315,47 +304,149 @@ static const uint8_t font_8x10[][10] = {
     {0x00,0x00,0x00,0x7E,0x06,0x0C,0x18,0x30,0x60,0x7E}, // z
     {0x18,0x3C,0x3C,0x18,0x00,0x00,0x00,0x00,0x00,0x00}, // °
     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x18,0x00}, // .
-    {0x60, 0x92, 0x94, 0x68, 0x10, 0x20, 0x4C, 0x52, 0x92, 0x0C},
+    {0x60,0x92,0x94,0x68,0x10,0x20,0x4C,0x52,0x92,0x0C}, // %
+
+};
 
+static const uint8_t font_8x10_map[128] = {
+    [' '] = 0,
+    MAP_DIGITS(1),
+    MAP_UPPER(11),
+    MAP_LOWER(37),
+    [','] = 63, ['.'] = 64, ['%'] = 65,
 };
 
-void draw_char_8x10(char c, int x, int y) {
-    uint8_t index;
-
-    if (c == ' ') {
-        index = 0;
-    } else if (c >= '0' && c <= '9') {
-        index = 1 + (c - '0');  // 1–10
-    } else if (c >= 'A' && c <= 'Z') {
-        index = 11 + (c - 'A'); // 11–36
-    } else if (c >= 'a' && c <= 'z') {
-        index = 37 + (c - 'a'); // 37–62
-    } else if (c == ',') {
-        index = 63;
-    } else if (c == '.') {
-        index = 64;
-    } else if(c=='%'){
-        index=65;
-    } 
-
-     else {
-        return; // unsupported
+const Font font_8x10 = {
+    .width = 8,
+    .height = 10,
+    .advance = 9,
+    .orientation = FONT_ROWS_MSB_LEFT,
+    .stride = sizeof(font_8x10_glyphs[0]),
+    .glyphs = &font_8x10_glyphs[0][0],
+    .map = font_8x10_map,
+};
+
+// Look up a glyph; anything outside 7-bit ASCII maps to glyph 0 as well
+static uint8_t glyph_index(const Font *font, char c) {
+    uint8_t code = (uint8_t)c;
+    return code < 128 ? font->map[code] : 0;
+}
+
+int text_advance(const Font *font, char c) {
+    if (font->orientation == FONT_BITSTREAM) {
+        return font->metrics[glyph_index(font, c)].advance;
     }
+    return font->advance;
+}
+
+// n <= 16 bits starting at bit pos, MSB first, returned top aligned in
+// a column word. Reads three bytes, bdf2c.py pads the stream for that.
+static uint16_t read_column(const uint8_t *bits, uint32_t pos, int n) {
+    const uint8_t *p = bits + pos / 8;
+    uint32_t window = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+    return (uint16_t)((window << (pos % 8)) >> 8) & (0xFFFF << (16 - n));
+}
 
-    for (int row = 0; row < 10; row++) {
-        uint8_t line = font_8x10[index][row];
-        for (int col = 0; col < 8; col++) {
-            if (line & (1 << (7 - col))) {
-                set_pixel(x + col, y + row);
-            }
+// Convert a glyph to the column words fb_blit_columns() takes
+static void glyph_columns(const Font *font, const uint8_t *glyph, uint16_t *cols) {
+    if (font->orientation == FONT_COLUMNS_LSB_TOP) {
+        // Columns are stored top pixel in bit 0, the framebuffer wants bit 15
+        for (int col = 0; col < font->width; col++) {
+            cols[col] = bit_reverse8(glyph[col]) << 8;
+        }
+        return;
+    }
+
+    // Rows are stored left pixel in bit 7: transpose them eight at a
+    // time, padding the last block with blank rows
+    for (int col = 0; col < font->width; col++) {
+        cols[col] = 0;
+    }
+    for (int row = 0; row < font->height; row += 8) {
+        uint8_t block[8] = { 0 };
+        uint8_t t[8];
+        for (int i = 0; i < 8 && row + i < font->height; i++) {
+            block[i] = glyph[row + i];
+        }
+        transpose8x8(block, t);
+        for (int col = 0; col < font->width; col++) {
+            cols[col] |= t[col] << (8 - row);
         }
     }
 }
 
-void draw_string_8x10(const char *text, int x, int y) {
-    while (*text) {
-        draw_char_8x10(*text, x, y);
-        x += 9;  // 8 pixels wide + 1 spacing
+// Proportional glyphs only cover their inked box, the rest of the cell
+// is left as it is
+void text_glyph(const Font *font, char c, uint16_t cols[FONT_MAX_WIDTH], FontGlyph *box) {
+    if (font->orientation == FONT_BITSTREAM) {
+        const FontGlyph *g = &font->metrics[glyph_index(font, c)];
+        for (int col = 0; col < g->width; col++) {
+            cols[col] = read_column(font->glyphs, g->offset + (uint32_t)col * g->rows, g->rows);
+        }
+        *box = *g;
+        return;
+    }
+
+    glyph_columns(font, font->glyphs + glyph_index(font, c) * font->stride, cols);
+    *box = (FontGlyph){
+        .width = font->width,
+        .rows = font->height,
+        .advance = font->advance,
+    };
+}
+
+void draw_char(const Font *font, char c, int x, int y) {
+    uint16_t cols[FONT_MAX_WIDTH];
+    FontGlyph box;
+
+    text_glyph(font, c, cols, &box);
+    fb_blit_columns(x + box.x_off, y + box.y_off, cols, box.width, box.rows);
+}
+
+void draw_string(const Font *font, const char *text, int x, int y) {
+    if (y >= DISPLAY_HEIGHT || y + font->height <= 0) {
+        return;
+    }
+    // Skip characters left of the screen (ink stays inside the advance,
+    // a left bearing can push it past font->width), stop at the right edge
+    while (*text && x + text_advance(font, *text) <= 0) {
+        x += text_advance(font, *text);
         text++;
     }
+    while (*text && x < DISPLAY_WIDTH) {
+        draw_char(font, *text, x, y);
+        x += text_advance(font, *text);
+        text++;
+    }
+}
+
+int text_width(const Font *font, const char *text) {
+    int width = 0;
+
+    if (font->orientation != FONT_BITSTREAM) {
+        while (text[width]) {
+            width++;
+        }
+        return width * font->advance;
+    }
+    while (*text) {
+        width += text_advance(font, *text++);
+    }
+    return width;
+}
+
+int text_align(const Font *font, const char *text, int x, TextAlign align) {
+    if (align == TEXT_ALIGN_RIGHT) {
+        return x - text_width(font, text);
+    }
+    if (align == TEXT_ALIGN_CENTER) {
+        return x - text_width(font, text) / 2;
+    }
+    return x;
+}
+
+int draw_string_aligned(const Font *font, const char *text, int x, int y, TextAlign align) {
+    x = text_align(font, text, x, align);
+    draw_string(font, text, x, y);
+    return x;
 }
@@ -1,21 +1,85 @@
 #ifndef TEXT_H
 #define TEXT_H
 
-// Draw a single character using 5x7 font
-void draw_char_5x7(char c, int x, int y);
-// Draw a string using 5x7 font
-void draw_string_5x7(const char *text, int x, int y);
+#include <stdint.h>
 
-// Draw a single character using 7x9 font
-void draw_char_7x9(char c, int x, int y);
-// Draw a string using 7x9 font
-void draw_string_7x9(const char *text, int x, int y);
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Widest glyph any font may have
+#define FONT_MAX_WIDTH 16
+
+// How a font stores its glyph bitmaps
+typedef enum {
+    FONT_COLUMNS_LSB_TOP,  // one byte per column, top pixel in bit 0 (height <= 8)
+    FONT_ROWS_MSB_LEFT,    // one byte per row, left pixel in bit 7 (height <= 16)
+    FONT_BITSTREAM,        // proportional: cropped glyphs in one bitstream, see FontGlyph
+} FontOrientation;
+
+// Where a proportional glyph's bitmap sits in its cell. The bitmap is
+// `width` columns of `rows` bits each, top pixel first, starting at bit
+// `offset` of Font.glyphs (MSB first).
+typedef struct {
+    uint16_t offset;
+    uint8_t width;
+    uint8_t rows;
+    uint8_t x_off;        // left bearing
+    uint8_t y_off;        // blank rows above the bitmap
+    uint8_t advance;
+} FontGlyph;
+
+// Bitmap font, monospaced unless it has per-glyph metrics
+typedef struct {
+    uint8_t width;        // (widest) glyph width in pixels, at most FONT_MAX_WIDTH
+    uint8_t height;       // glyph height in pixels
+    uint8_t advance;      // distance from one character to the next (widest)
+    uint8_t orientation;  // FontOrientation
+    uint8_t stride;       // bytes per glyph, 0 for FONT_BITSTREAM
+    const uint8_t *glyphs;
+    const uint8_t *map;   // 128 entries, ASCII code -> glyph index
+    const FontGlyph *metrics;  // FONT_BITSTREAM only
+} Font;
 
+// How draw_string_aligned() places text relative to x
+typedef enum {
+    TEXT_ALIGN_LEFT,       // x is the left edge
+    TEXT_ALIGN_RIGHT,      // x is the right edge
+    TEXT_ALIGN_CENTER,     // x is the middle
+} TextAlign;
 
-void draw_char_8x12(char c, int x, int y);
+extern const Font font_5x7;
+extern const Font font_7x9;
+extern const Font font_8x10;
+// Generated from assets/*.bdf by scripts/bdf2c.py
+extern const Font font_numerals14;
 
-void draw_string_8x12(const char *text, int x, int y);
+// Draw a single character with its top left corner at (x, y)
+void draw_char(const Font *font, char c, int x, int y);
 
+// A character as column words for fb_blit_columns() (top pixel in bit
+// 15). box receives where the columns go in the character cell: box->width
+// columns of box->rows rows at (x_off, y_off), and the advance. The offset
+// field is not used.
+void text_glyph(const Font *font, char c, uint16_t cols[FONT_MAX_WIDTH], FontGlyph *box);
 
+// Distance draw_string() moves on after c
+int text_advance(const Font *font, char c);
 
+// Draw a string on one line
+void draw_string(const Font *font, const char *text, int x, int y);
+
+// Width in pixels draw_string() advances over for text
+int text_width(const Font *font, const char *text);
+
+// Left edge of text aligned to x, from a text_width() pre-pass
+int text_align(const Font *font, const char *text, int x, TextAlign align);
+
+// draw_string() at the left edge text_align() picks; returns that edge
+int draw_string_aligned(const Font *font, const char *text, int x, int y, TextAlign align);
+
+#ifdef __cplusplus
+}
 #endif
+
+#endif // TEXT_H
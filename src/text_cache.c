@@ -0,0 +1,124 @@
+#include "text_cache.h"
+#include "framebuffer.h"
+#include <string.h>
+
+#define ARENA_WORDS (TEXT_CACHE_SIZE / 2)
+
+// A rendered string, width column words from arena[offset]
+struct entry {
+    const Font *font;
+    char key[TEXT_CACHE_KEY_LEN];
+    uint16_t offset;
+    uint16_t width;
+    uint32_t used;  // tick of the last hit
+};
+
+// Entries are kept in arena order, packed from the start, so evicting
+// one moves the ones after it down and the free space stays at the end
+static uint16_t arena[ARENA_WORDS];
+static struct entry entries[TEXT_CACHE_ENTRIES];
+static int count;
+static int top;  // words in use
+static uint32_t tick;
+static struct text_cache_stats stats;
+
+static void evict(int i) {
+    int width = entries[i].width;
+    int end = entries[i].offset + width;
+
+    memmove(&arena[entries[i].offset], &arena[end], (top - end) * sizeof(arena[0]));
+    for (int j = i + 1; j < count; j++) {
+        entries[j].offset -= width;
+        entries[j - 1] = entries[j];
+    }
+    count--;
+    top -= width;
+    stats.evictions++;
+}
+
+static int least_recently_used(void) {
+    int lru = 0;
+
+    for (int i = 1; i < count; i++) {
+        if (entries[i].used < entries[lru].used) {
+            lru = i;
+        }
+    }
+    return lru;
+}
+
+// Render text into the arena; NULL when it cannot be cached
+static struct entry *insert(const Font *font, const char *text) {
+    int width = text_width(font, text);
+
+    if (font->height > 16 || strlen(text) >= TEXT_CACHE_KEY_LEN || width == 0 ||
+        width > ARENA_WORDS) {
+        return NULL;
+    }
+    while (count == TEXT_CACHE_ENTRIES || top + width > ARENA_WORDS) {
+        evict(least_recently_used());
+    }
+
+    struct entry *e = &entries[count++];
+    uint16_t *run = &arena[top];
+    e->font = font;
+    strcpy(e->key, text);
+    e->offset = top;
+    e->width = width;
+    top += width;
+
+    // Glyphs stay inside their advance, so ORing them side by side gives
+    // the same pixels as drawing them one by one
+    memset(run, 0, width * sizeof(run[0]));
+    for (int x = 0; *text; text++) {
+        uint16_t cols[FONT_MAX_WIDTH];
+        FontGlyph box;
+
+        text_glyph(font, *text, cols, &box);
+        for (int col = 0; col < box.width && x + box.x_off + col < width; col++) {
+            run[x + box.x_off + col] |= cols[col] >> box.y_off;
+        }
+        x += box.advance;
+    }
+    return e;
+}
+
+static struct entry *lookup(const Font *font, const char *text) {
+    for (int i = 0; i < count; i++) {
+        if (entries[i].font == font && strcmp(entries[i].key, text) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+void text_cache_draw(const Font *font, const char *text, int x, int y) {
+    if (y >= DISPLAY_HEIGHT || y + font->height <= 0 || *text == '\0') {
+        return;
+    }
+
+    struct entry *e = lookup(font, text);
+    if (e) {
+        stats.hits++;
+        stats.glyphs_saved += strlen(text);
+    } else {
+        stats.misses++;
+        e = insert(font, text);
+        if (!e) {
+            draw_string(font, text, x, y);
+            return;
+        }
+    }
+    e->used = ++tick;
+    fb_blit_columns(x, y, &arena[e->offset], e->width, font->height);
+}
+
+void text_cache_clear(void) {
+    count = 0;
+    top = 0;
+}
+
+void text_cache_get_stats(struct text_cache_stats *out) {
+    *out = stats;
+    out->bytes_used = top * sizeof(arena[0]);
+}
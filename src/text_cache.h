@@ -0,0 +1,41 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <stdint.h>
+#include "text.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Labels rendered once into the column words fb_blit_columns() takes and
+// kept in a fixed arena, least recently used out first. A cached label
+// is drawn with one blit, a shifted word and two or three byte ANDs per
+// column, instead of a glyph lookup and conversion per character.
+#define TEXT_CACHE_SIZE     CONFIG_APP_TEXT_CACHE_SIZE
+#define TEXT_CACHE_ENTRIES  8
+#define TEXT_CACHE_KEY_LEN  16
+
+struct text_cache_stats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t glyphs_saved;  // characters hits did not have to render
+    uint32_t bytes_used;
+};
+
+// Same as draw_string(). Strings up to TEXT_CACHE_KEY_LEN - 1 characters
+// in fonts up to 16 pixels high are served from the cache, anything
+// else is drawn directly.
+void text_cache_draw(const Font *font, const char *text, int x, int y);
+
+// Drop every entry; the counters are kept
+void text_cache_clear(void);
+
+void text_cache_get_stats(struct text_cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEXT_CACHE_H
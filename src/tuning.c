@@ -0,0 +1,85 @@
+#include "tuning.h"
+#include "epd.h"
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+static struct k_spinlock period_lock;
+static uint32_t period_min_ms = CONFIG_APP_SAMPLE_PERIOD_MIN_MS;
+static uint32_t period_max_ms = CONFIG_APP_SAMPLE_PERIOD_MAX_MS;
+
+static atomic_t thresholds[UI_FIELD_COUNT];
+static atomic_t thresholds_set;  // bit per field, the others follow the layout
+static atomic_t full_refresh_interval = ATOMIC_INIT(CONFIG_APP_FULL_REFRESH_INTERVAL);
+static atomic_t quiet = ATOMIC_INIT(IS_ENABLED(CONFIG_APP_QUIET));
+static atomic_t generation;
+
+static K_SEM_DEFINE(tuning_changed, 0, 1);
+
+static void bump(void) {
+    atomic_inc(&generation);
+    k_sem_give(&tuning_changed);
+}
+
+int tuning_set_period(uint32_t min_ms, uint32_t max_ms) {
+    if (min_ms == 0 || min_ms > max_ms) {
+        return -EINVAL;
+    }
+    k_spinlock_key_t key = k_spin_lock(&period_lock);
+    period_min_ms = min_ms;
+    period_max_ms = max_ms;
+    k_spin_unlock(&period_lock, key);
+    bump();
+    return 0;
+}
+
+void tuning_get_period(uint32_t *min_ms, uint32_t *max_ms) {
+    k_spinlock_key_t key = k_spin_lock(&period_lock);
+    *min_ms = period_min_ms;
+    *max_ms = period_max_ms;
+    k_spin_unlock(&period_lock, key);
+}
+
+void tuning_set_threshold(enum ui_field field, q16_t min) {
+    atomic_set(&thresholds[field], min);
+    atomic_set_bit(&thresholds_set, field);
+    bump();
+}
+
+bool tuning_get_threshold(enum ui_field field, q16_t *min) {
+    if (!atomic_test_bit(&thresholds_set, field)) {
+        return false;
+    }
+    *min = (q16_t)atomic_get(&thresholds[field]);
+    return true;
+}
+
+void tuning_set_full_refresh_interval(int partials) {
+    atomic_set(&full_refresh_interval, partials);
+    bump();
+}
+
+int tuning_full_refresh_interval(void) {
+    return (int)atomic_get(&full_refresh_interval);
+}
+
+void tuning_request_full_refresh(void) {
+    epd_request_full_refresh();
+    bump();
+}
+
+void tuning_set_quiet(bool on) {
+    atomic_set(&quiet, on);
+}
+
+bool tuning_quiet(void) {
+    return atomic_get(&quiet) != 0;
+}
+
+uint32_t tuning_generation(void) {
+    return (uint32_t)atomic_get(&generation);
+}
+
+void tuning_sleep_until(int64_t deadline_ms) {
+    k_sem_take(&tuning_changed, K_TIMEOUT_ABS_MS(deadline_ms));
+}
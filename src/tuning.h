@@ -0,0 +1,45 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "q16.h"
+#include "ui.h"
+
+// Settings that can be changed while the app runs (from the shell), so a
+// deployment can be tuned without reflashing. They start from Kconfig
+// and the layout, and are not kept across a reset. Any thread may read
+// or set them; the sample loop and the render thread pick changes up on
+// their next cycle.
+
+// Limits for the adaptive sample period. Fails with -EINVAL unless
+// 0 < min_ms <= max_ms.
+int tuning_set_period(uint32_t min_ms, uint32_t max_ms);
+void tuning_get_period(uint32_t *min_ms, uint32_t *max_ms);
+
+// Show the icons that depend on field from min on instead of the
+// layout's own threshold
+void tuning_set_threshold(enum ui_field field, q16_t min);
+
+// The threshold set for field; false while the layout's applies
+bool tuning_get_threshold(enum ui_field field, q16_t *min);
+
+// Partial refreshes between two full ones, 0 for full refreshes only
+void tuning_set_full_refresh_interval(int partials);
+int tuning_full_refresh_interval(void);
+
+// Make the next frame a full refresh, and take it now
+void tuning_request_full_refresh(void);
+
+// Quiet drops the prints made every sample cycle
+void tuning_set_quiet(bool quiet);
+bool tuning_quiet(void);
+
+// Bumped by every change, so a thread can tell when to apply them
+uint32_t tuning_generation(void);
+
+// Sleep until the uptime reaches deadline_ms or a setting changes,
+// whichever comes first
+void tuning_sleep_until(int64_t deadline_ms);
+
+#endif // TUNING_H
@@ -0,0 +1,326 @@
+#include "ui.h"
+#include "bigtext.h"
+#include "framebuffer.h"
+#include "prof.h"
+#include "text_cache.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef __ZEPHYR__
+#include <zephyr/devicetree.h>
+#define UI_DT_LAYOUT DT_HAS_CHOSEN(tempdemo_layout)
+#else
+#define UI_DT_LAYOUT 0
+#endif
+
+#define LABEL(x_, y_, text_) \
+    { .type = WIDGET_LABEL, .x = (x_), .y = (y_), .font = &font_8x10, \
+      .text = (text_), .when = UI_ALWAYS }
+#define VALUE(x_, y_, font_, field_, unit_) \
+    { .type = WIDGET_VALUE, .x = (x_), .y = (y_), .font = (font_), \
+      .align = TEXT_ALIGN_RIGHT, .field = (field_), .text = (unit_), .when = UI_ALWAYS }
+#define BIG_VALUE(x_, y_, font_, scale_, field_, unit_) \
+    { .type = WIDGET_VALUE, .x = (x_), .y = (y_), .font = (font_), .scale = (scale_), \
+      .align = TEXT_ALIGN_RIGHT, .field = (field_), .text = (unit_), .when = UI_ALWAYS }
+#define ICON(x_, y_, image_, when_, min_) \
+    { .type = WIDGET_ICON, .x = (x_), .y = (y_), .image = (image_), \
+      .when = (when_), .when_min = (min_) }
+#define GRAPH(x_, y_, graph_) \
+    { .type = WIDGET_GRAPH, .x = (x_), .y = (y_), .graph = (graph_), .when = UI_ALWAYS }
+
+// Name of the location on screen, empty with a single location
+static char title[16];
+
+#if UI_DT_LAYOUT
+// The layout comes from the devicetree (dts/bindings/tempdemo,layout.yaml),
+// one widget per child node of the chosen "tempdemo,layout". The enums of
+// the binding list their values in the order of the C enums.
+#define DT_GRAPH_NAME(n) UTIL_CAT(layout_graph_, DT_DEP_ORD(n))
+#define DT_GRAPH(n) \
+    COND_CODE_1(DT_ENUM_HAS_VALUE(n, type, graph), \
+        (static struct graph DT_GRAPH_NAME(n) = { \
+            .channel = DT_ENUM_IDX(n, channel), \
+            .w = DT_PROP(n, width), \
+            .h = DT_PROP(n, height), \
+            .step = DT_PROP(n, step), \
+            .min_span = DT_PROP(n, min_span), \
+        };), ())
+// Labels without text show the title
+#define DT_TEXT(n) \
+    COND_CODE_1(DT_NODE_HAS_PROP(n, text), (DT_PROP(n, text)), \
+        (COND_CODE_1(DT_ENUM_HAS_VALUE(n, type, label), (title), (""))))
+#define DT_WIDGET(n) \
+    { .type = DT_ENUM_IDX(n, type), .x = DT_PROP(n, x), .y = DT_PROP(n, y), \
+      .font = &DT_STRING_TOKEN(n, font), .scale = DT_PROP(n, scale), \
+      .align = DT_ENUM_IDX(n, align), .text = DT_TEXT(n), \
+      .image = COND_CODE_1(DT_NODE_HAS_PROP(n, image), (&DT_STRING_TOKEN(n, image)), (NULL)), \
+      .graph = COND_CODE_1(DT_ENUM_HAS_VALUE(n, type, graph), (&DT_GRAPH_NAME(n)), (NULL)), \
+      .field = DT_ENUM_IDX_OR(n, field, 0), .when = DT_ENUM_IDX(n, when), \
+      .when_min = (q16_t)(((int64_t)DT_PROP(n, when_min) << 16) / 100) },
+
+DT_FOREACH_CHILD_STATUS_OKAY(DT_CHOSEN(tempdemo_layout), DT_GRAPH)
+
+static struct widget widgets[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_CHOSEN(tempdemo_layout), DT_WIDGET)
+};
+#else
+// Built-in layout for the 2.13" panel, used by the host build and by
+// boards without a layout in their devicetree. The board overlay has the
+// same one; render_host_dt draws that and compares the frames.
+
+// Temperature over the last HISTORY_BUCKETS buckets, in whole degrees
+static struct graph temp_graph = {
+    .channel = HISTORY_TEMP,
+    .w = 80,
+    .h = 40,
+    .step = 100,
+    .min_span = 200,
+};
+
+// Values are right aligned, x is where their unit ends. The temperature
+// is the large numerals at twice their size, under its label.
+static struct widget widgets[] = {
+    LABEL(9, 4, title),
+    LABEL(9, 20, "Humidity"),
+    VALUE(144, 20, &font_8x10, UI_HUMIDITY, "%"),
+    LABEL(9, 34, "Temperature"),
+    BIG_VALUE(150, 47, &font_numerals14, 2, UI_TEMP_C, ",C"),
+    LABEL(9, 91, "Heat Index"),
+    VALUE(171, 91, &font_8x10, UI_HEAT_INDEX_C, ",C"),
+    ICON(146, 13, &raindrop, UI_HUMIDITY, Q16_FROM_INT(50)),
+    ICON(192, 56, &flame, UI_HEAT_INDEX_C, Q16_FROM_INT(26)),
+    GRAPH(175, 8, &temp_graph),
+};
+#endif
+#define WIDGET_COUNT (sizeof(widgets) / sizeof(widgets[0]))
+
+// Glyph masks for ui_update(): bit i set = character i has to be drawn,
+// ALL_GLYPHS = the whole widget is new
+#define ALL_GLYPHS 0xFFFF
+_Static_assert(sizeof(widgets[0].shown) <= 16, "glyph masks hold 16 characters");
+
+static int offset_x;
+static int offset_y;
+
+// Two decimals and the unit, e.g. "45.00%"
+static void format_value(char *buf, size_t size, q16_t value, const char *unit) {
+    int32_t centi = q16_to_centi(value);
+    const char *sign = centi < 0 ? "-" : "";
+
+    if (centi < 0) {
+        centi = -centi;
+    }
+    snprintf(buf, size, "%s%d.%02d%s", sign, (int)centi / 100, (int)centi % 100, unit);
+}
+
+static void erase(struct widget *w) {
+    if (w->drawn.w > 0) {
+        fb_clear_rect(w->drawn.x, w->drawn.y, w->drawn.w, w->drawn.h);
+        fb_mark_dirty(w->drawn.x, w->drawn.y, w->drawn.w, w->drawn.h);
+        w->drawn.w = 0;
+    }
+}
+
+static int scale_of(const struct widget *w) {
+    return w->scale > 1 ? w->scale : 1;
+}
+
+// Left edge of a widget showing text, before the layout offset
+static int left_edge(const struct widget *w, const char *text) {
+    if (w->type == WIDGET_ICON) {
+        return w->x;
+    }
+    int width = bigtext_width(w->font, text, scale_of(w));
+    if (w->align == TEXT_ALIGN_RIGHT) {
+        return w->x - width;
+    }
+    if (w->align == TEXT_ALIGN_CENTER) {
+        return w->x - width / 2;
+    }
+    return w->x;
+}
+
+static void clear_cell(int x, int y, int w, int h) {
+    fb_clear_rect(x, y, w, h);
+    fb_mark_dirty(x, y, w, h);
+}
+
+// Work out which characters of a value have to change when it goes from
+// w->shown at w->drawn.x to text at x, on the same row. Characters that
+// are the same glyph at the same position stay on screen, every other old
+// cell is cleared now. Returns the mask of new characters to draw.
+static uint16_t diff_glyphs(struct widget *w, const char *text, int x) {
+    const char *old = w->shown;
+    int old_x = w->drawn.x;
+    int scale = scale_of(w);
+    int y = w->drawn.y;
+    int h = w->drawn.h;
+    uint16_t fresh = 0;
+
+    // Both strings are laid out left to right, so walk them together by
+    // position
+    for (int i = 0, j = 0; text[i] || old[j];) {
+        int new_adv = text[i] ? text_advance(w->font, text[i]) * scale : 0;
+        int old_adv = old[j] ? text_advance(w->font, old[j]) * scale : 0;
+
+        if (old[j] && (!text[i] || old_x < x)) {
+            clear_cell(old_x, y, old_adv, h);
+            old_x += old_adv;
+            j++;
+        } else if (text[i] && (!old[j] || x < old_x)) {
+            fresh |= 1u << i;
+            x += new_adv;
+            i++;
+        } else {
+            if (text[i] != old[j]) {
+                clear_cell(old_x, y, old_adv, h);
+                fresh |= 1u << i;
+            }
+            old_x += old_adv;
+            x += new_adv;
+            i++;
+            j++;
+        }
+    }
+    return fresh;
+}
+
+static void draw(struct widget *w, const char *text) {
+    int x = left_edge(w, text) + offset_x;
+    int y = w->y + offset_y;
+    int width, height;
+
+    if (w->type == WIDGET_ICON) {
+        draw_my_image(x, y, w->image);
+        width = w->image->width;
+        height = w->image->height;
+    } else if (w->type == WIDGET_LABEL && scale_of(w) == 1) {
+        // Labels hardly ever change, they are blitted from the cache
+        text_cache_draw(w->font, text, x, y);
+        width = text_width(w->font, text);
+        height = w->font->height;
+    } else {
+        bigtext_draw_string(w->font, text, x, y, scale_of(w));
+        width = bigtext_width(w->font, text, scale_of(w));
+        height = w->font->height * scale_of(w);
+    }
+    fb_mark_dirty(x, y, width, height);
+    w->drawn.x = x;
+    w->drawn.y = y;
+    w->drawn.w = width;
+    w->drawn.h = height;
+}
+
+// Draw only the characters diff_glyphs() picked, into the cells it left
+// clear; w->drawn already covers the new text
+static void draw_glyphs(struct widget *w, const char *text, uint16_t glyphs) {
+    int x = w->drawn.x;
+    int scale = scale_of(w);
+
+    for (int i = 0; text[i]; i++) {
+        int adv = text_advance(w->font, text[i]) * scale;
+        if (glyphs & (1u << i)) {
+            bigtext_draw_char(w->font, text[i], x, w->drawn.y, scale);
+            fb_mark_dirty(x, w->drawn.y, adv, w->drawn.h);
+        }
+        x += adv;
+    }
+}
+
+void ui_update(const q16_t values[UI_FIELD_COUNT]) {
+    uint16_t redraw[WIDGET_COUNT];
+
+    PROF_BEGIN(t_format);
+
+    // Erase everything that changes before drawing anything, so a widget
+    // that moved or shrank cannot wipe out a neighbour drawn this round
+    for (size_t i = 0; i < WIDGET_COUNT; i++) {
+        struct widget *w = &widgets[i];
+        if (w->type == WIDGET_GRAPH) {
+            redraw[i] = 0;
+            continue;
+        }
+
+        bool visible = w->when == UI_ALWAYS || values[w->when] >= w->when_min;
+        char text[sizeof(w->shown)] = "";
+
+        if (w->type == WIDGET_VALUE) {
+            format_value(text, sizeof(text), values[w->field], w->text);
+        } else if (w->type == WIDGET_LABEL) {
+            strncpy(text, w->text, sizeof(text) - 1);
+        }
+        int x = left_edge(w, text);
+        bool moved = w->drawn.x != x + offset_x || w->drawn.y != w->y + offset_y;
+
+        redraw[i] = 0;
+        if (visible && w->visible && w->type == WIDGET_VALUE && w->drawn.y == w->y + offset_y) {
+            // Same row: leave the characters that did not change alone
+            redraw[i] = diff_glyphs(w, text, x + offset_x);
+            w->drawn.x = x + offset_x;
+            w->drawn.w = bigtext_width(w->font, text, scale_of(w));
+        } else if (visible != w->visible || (visible && moved) || strcmp(text, w->shown) != 0) {
+            erase(w);
+            redraw[i] = ALL_GLYPHS;
+        }
+        w->visible = visible;
+        strcpy(w->shown, text);
+    }
+
+    PROF_END(PROF_FORMAT, t_format);
+
+    PROF_BEGIN(t_draw);
+    for (size_t i = 0; i < WIDGET_COUNT; i++) {
+        if (widgets[i].type == WIDGET_GRAPH) {
+            graph_update(widgets[i].graph, widgets[i].x + offset_x, widgets[i].y + offset_y);
+        } else if (redraw[i] == ALL_GLYPHS && widgets[i].visible) {
+            draw(&widgets[i], widgets[i].type == WIDGET_LABEL ? widgets[i].text : widgets[i].shown);
+        } else if (redraw[i]) {
+            draw_glyphs(&widgets[i], widgets[i].shown, redraw[i]);
+        }
+    }
+    PROF_END(PROF_DRAW, t_draw);
+}
+
+void ui_repaint(void) {
+    fb_clear();
+    fb_mark_dirty(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    for (size_t i = 0; i < WIDGET_COUNT; i++) {
+        widgets[i].visible = false;
+        widgets[i].shown[0] = '\0';
+        widgets[i].drawn.w = 0;
+        if (widgets[i].type == WIDGET_GRAPH) {
+            graph_reset(widgets[i].graph);
+        }
+    }
+}
+
+void ui_set_title(const char *text) {
+    strncpy(title, text, sizeof(title) - 1);
+}
+
+int ui_set_threshold(enum ui_field field, q16_t min) {
+    int n = 0;
+
+    for (size_t i = 0; i < WIDGET_COUNT; i++) {
+        if (widgets[i].when == field) {
+            widgets[i].when_min = min;
+            n++;
+        }
+    }
+    return n;
+}
+
+int ui_get_threshold(enum ui_field field, q16_t *min) {
+    for (size_t i = 0; i < WIDGET_COUNT; i++) {
+        if (widgets[i].when == field) {
+            *min = widgets[i].when_min;
+            return 0;
+        }
+    }
+    return -ENOENT;
+}
+
+void ui_set_offset(int dx, int dy) {
+    offset_x = dx;
+    offset_y = dy;
+}
@@ -0,0 +1,86 @@
+#ifndef UI_H
+#define UI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "graph.h"
+#include "my_image.h"
+#include "q16.h"
+#include "text.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Values the widgets can show or depend on
+enum ui_field {
+    UI_TEMP_C,
+    UI_TEMP_F,
+    UI_HUMIDITY,
+    UI_HEAT_INDEX_C,
+    UI_DEW_POINT_C,
+    UI_FIELD_COUNT,
+    UI_ALWAYS = UI_FIELD_COUNT,  // visibility: no condition
+};
+
+enum widget_type {
+    WIDGET_LABEL,  // fixed text
+    WIDGET_VALUE,  // a field printed with two decimals and a unit
+    WIDGET_ICON,
+    WIDGET_GRAPH,  // history sparkline, keeps its own state
+};
+
+// Widgets are only visible while values[when] >= when_min
+struct widget {
+    uint8_t type;
+    int16_t x;
+    int16_t y;
+    const Font *font;
+    uint8_t align;       // TextAlign: text widgets are aligned to x
+    uint8_t scale;       // text drawn this many times its size, 0 = 1
+    const char *text;    // label text, or the unit after a value
+    const Img *image;
+    struct graph *graph;
+    uint8_t field;       // value widgets: what to print
+    uint8_t when;        // enum ui_field or UI_ALWAYS
+    q16_t when_min;
+
+    // Retained state: what is on screen right now
+    bool visible;
+    char shown[16];
+    struct {
+        int16_t x, y, w, h;
+    } drawn;
+};
+
+// Redraw every widget whose text or visibility changed since the last
+// call. Touched areas (old and new bounding boxes) are cleared and marked
+// dirty on the bound framebuffer, ready for a partial refresh. A value
+// that stays put only has its changed characters redrawn.
+void ui_update(const q16_t values[UI_FIELD_COUNT]);
+
+// Forget what is on screen: the framebuffer is cleared and the next
+// ui_update() draws every visible widget again
+void ui_repaint(void);
+
+// Show text (up to 15 characters) as the title at the top left, e.g. the
+// name of the location the values are from. Empty by default; takes
+// effect on the next ui_update().
+void ui_set_title(const char *text);
+
+// Show the icons that depend on field from min on. Returns the number
+// of widgets changed; takes effect on the next ui_update().
+int ui_set_threshold(enum ui_field field, q16_t min);
+
+// Threshold of the first icon that depends on field, -ENOENT if none does
+int ui_get_threshold(enum ui_field field, q16_t *min);
+
+// Move the whole layout by (dx, dy) pixels, e.g. to spread out burn-in.
+// Widgets move on the next ui_update().
+void ui_set_offset(int dx, int dy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_H